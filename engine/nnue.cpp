@@ -1,5 +1,6 @@
 #include "nnue.hpp"
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include "incbin.h"
 extern "C" {
@@ -86,11 +87,8 @@ void Network::load() {
 
 
 void init_accumulator(Accumulator& acc, const Network* net) {
-    for (int i = 0; i < HIDDEN_SIZE; i++){
+    for (int i = 0; i < HIDDEN_SIZE; i++)
         acc.vals[i] = net->feature_bias[i];
-        std::cout<<"FUCCK "<<acc.vals[i]<<"\n";
-    }
-        
 }
 
 int32_t evaluate(const Network* net, const Accumulator& us, const Accumulator& them) {
@@ -1,9 +1,10 @@
 #pragma once
 #include "../game/movegen.hpp"
 #include "../game/board.hpp"
-#include <vector>
-#include <algorithm>
-static int pieceValue[7] = {
+#include "../game/attacks.hpp"
+#include "searchthread.hpp"
+#include <utility>
+constexpr int pieceValue[7] = {
     0,     // EMPTY
     100,   // PAWN
     300,   // KNIGHT
@@ -13,55 +14,280 @@ static int pieceValue[7] = {
     10000  // KING
 };
 
-// Stores history scores: piece x square
-static int historyTable[13][64] = {{0}};
+// define for move equality
 
-// Stores 2 killer moves per depth
-static Move killerMoves[128][2];
 
-// define for move equality
+// MVV-LVA: most valuable victim first, then least valuable attacker
+inline int captureScore(const Board& board, Move m) {
+    Piece captured = (m.flag() == EN_PASSANT) ? P : board.getPiece(m.to());
+    int victim = (captured == NO_PIECE) ? 0 : pieceValue[captured % 6 + 1];
+    int attacker = pieceValue[board.getPiece(m.from()) % 6 + 1];
+    if (m.flag() == PROMOTION_QUEEN)
+        victim += pieceValue[5]; // pawn becomes a queen
+    return victim * 1000 - attacker;
+}
 
+// --- Static exchange evaluation ---
+/*
+Does playing `m` win at least `threshold` once both sides have captured
+back and forth on the target square, each always using its least valuable
+attacker? Pieces that leave the board can uncover sliders behind them
+(x-rays), so the attackers are recomputed along the ray after every
+bishop, rook, queen or pawn capture. Either side may stop capturing when
+that's better for it.
+*/
+inline bool see(const Board& board, Move m, int threshold) {
+    if (m.flag() == KING_CASTLE || m.flag() == QUEEN_CASTLE)
+        return threshold <= 0;
 
-inline void scoreMove(const Board& board, Move& m, int depth) {
-    if (m.flag == CAPTURE) {
-        // MVV-LVA: Victim value * 1000 - attacker value
-        int victim = pieceValue[m.captured];
-        int attacker = pieceValue[m.piece];
-        m.score = 1000000 + victim * 1000 - attacker;
-        return;
+    int from = m.from(), to = m.to();
+    int capSquare = (m.flag() == EN_PASSANT) ? to + (board.turn == WHITE ? -8 : 8) : to;
+    Piece captured = board.getPiece(capSquare);
+    int nextVictim = board.getPiece(from) % 6; // type on `to` after the move
+
+    // what we win right away, minus what we need
+    int balance = (captured == NO_PIECE ? 0 : pieceValue[captured % 6 + 1]) - threshold;
+    if (m.isPromotion()) {
+        int promo = m.flag() == PROMOTION_QUEEN ? Q : m.flag() == PROMOTION_ROOK ? R
+                  : m.flag() == PROMOTION_BISHOP ? B : N;
+        balance += pieceValue[promo + 1] - pieceValue[P + 1];
+        nextVictim = promo;
     }
+    if (balance < 0) return false; // even a free capture isn't enough
 
-    // Killer moves
-    if (killerMoves[depth][0] == m)
-        { m.score = 900000; return; }
-    if (killerMoves[depth][1] == m)
-        { m.score = 800000; return; }
+    // assume the opponent takes our piece for nothing: still good?
+    balance -= pieceValue[nextVictim + 1];
+    if (balance >= 0) return true;
 
-    // Quiet move: use history heuristic
-    m.score = historyTable[m.piece][m.to];
-}
+    uint64_t occ = (board.occupancy[BOTH].board ^ (1ULL << from) ^ (1ULL << capSquare)) | (1ULL << to);
+    uint64_t diag = board.pieces[B].board | board.pieces[b].board | board.pieces[Q].board | board.pieces[q].board;
+    uint64_t line = board.pieces[R].board | board.pieces[r].board | board.pieces[Q].board | board.pieces[q].board;
+    uint64_t attackers = board.attackersTo(to, occ) & occ;
 
-inline void orderMoves(Board& board, std::vector<Move>& moves, int depth) {
-    for (auto& m : moves)
-        scoreMove(board, m, depth);
+    int side = !board.turn;
+    while (true) {
+        uint64_t ours = attackers & board.occupancy[side].board;
+        if (!ours) break;
 
-    std::sort(moves.begin(), moves.end(),
-              [](const Move& a, const Move& b) {
-                  return a.score > b.score;
-              });
-}
+        // least valuable attacker
+        int type = P;
+        while (!(ours & board.pieces[side == WHITE ? type : type + 6].board))
+            type++;
+
+        // take it off its square, which may uncover a slider behind it
+        occ ^= 1ULL << __builtin_ctzll(ours & board.pieces[side == WHITE ? type : type + 6].board);
+        if (type == P || type == B || type == Q)
+            attackers |= bishopAttacks(to, occ) & diag;
+        if (type == R || type == Q)
+            attackers |= rookAttacks(to, occ) & line;
+        attackers &= occ;
 
-// Save killer moves
-inline void addKiller(Move m, int depth) {
-    if (!(killerMoves[depth][0] == m)) {
-        killerMoves[depth][1] = killerMoves[depth][0];
-        killerMoves[depth][0] = m;
+        side = !side;
+        // negamax the balance: the side that just captured is now ahead by
+        // -balance, minus the piece it leaves on `to`
+        balance = -balance - 1 - pieceValue[type + 1];
+        if (balance >= 0) {
+            // capturing with the king into a defended square is illegal
+            if (type == K && (attackers & board.occupancy[side].board))
+                side = !side;
+            break;
+        }
     }
-}
 
-// Update history on quiet move causing beta cutoff
-inline void updateHistory(Move m, int depth) {
-    historyTable[m.piece][m.to] += depth * depth;
-    if (historyTable[m.piece][m.to] > 100000000)
-        historyTable[m.piece][m.to] /= 2;
+    // the side to move after the exchange is the one that lost it
+    return side != board.turn;
 }
+
+// Stages of the move picker, in the order their moves come out
+enum PickStage {
+    STAGE_TT_MOVE,
+    STAGE_GEN_CAPTURES,
+    STAGE_CAPTURES,
+    STAGE_KILLER_1,
+    STAGE_KILLER_2,
+    STAGE_COUNTER_MOVE,
+    STAGE_GEN_QUIETS,
+    STAGE_QUIETS,
+    STAGE_BAD_CAPTURES,
+    STAGE_GEN_EVASIONS,
+    STAGE_EVASIONS,
+    STAGE_DONE
+};
+
+// Hands out the legal moves of a position one at a time, best first.
+// Each group is only generated once the previous one is used up, so a
+// node that cuts off on the hash move or a capture never generates quiets.
+// Captures that lose material (by SEE) wait until after the quiets.
+// Captures are ordered by MVV-LVA plus their capture history; quiets come
+// as killers, counter move, then by history plus the continuation history
+// of the last two moves.
+class MovePicker {
+public:
+    // Main search: every legal move (only the check evasions if `inCheck`)
+    MovePicker(const Board& board, Move ttMove, const SearchThread& td, int ply, bool inCheck = false)
+        : board(board), ttMove(ttMove), killer1(td.stack[ply].killers[0]), killer2(td.stack[ply].killers[1]),
+          counter(td.counterMove(ply)), td(td), cont{td.contHist(ply, 1), td.contHist(ply, 2)},
+          evasion(inCheck) {}
+
+    // Quiescence: captures and queen promotions that don't lose material,
+    // then quiet checks if `quietChecks` is set (every check evasion
+    // instead if we are in check)
+    MovePicker(const Board& board, Move ttMove, const SearchThread& td, int ply, bool inCheck, bool quietChecks)
+        : board(board), ttMove(ttMove), killer1(Move::none()), killer2(Move::none()), counter(Move::none()),
+          td(td), cont{td.contHist(ply, 1), td.contHist(ply, 2)},
+          evasion(inCheck), quietGen(QUIET_CHECKS), skipQuiets(!quietChecks), keepBadCaptures(false) {}
+
+    // next move to search (Move::none() when there are none left)
+    Move next() {
+        while (true) {
+            if (skipQuiets && stage >= STAGE_KILLER_1 && stage <= STAGE_QUIETS)
+                stage = STAGE_BAD_CAPTURES;
+
+            switch (stage) {
+                case STAGE_TT_MOVE:
+                    stage = evasion ? STAGE_GEN_EVASIONS : STAGE_GEN_CAPTURES;
+                    if (MoveGenerator::isLegal(board, ttMove))
+                        return ttMove;
+                    break;
+
+                case STAGE_GEN_CAPTURES:
+                    moves = MoveGenerator::generateMoves(board, CAPTURES);
+                    for (int i = 0; i < moves.size(); i++)
+                        scores[i] = captureOrder(moves[i]);
+                    cur = 0;
+                    stage = STAGE_CAPTURES;
+                    break;
+
+                case STAGE_CAPTURES:
+                    if (cur < moves.size()) {
+                        Move m = pickBest();
+                        if (m == ttMove) break;
+                        if (!see(board, m, 0)) { // loses material: try it last
+                            badCaptures[badCount++] = m;
+                            break;
+                        }
+                        return m;
+                    }
+                    stage = STAGE_KILLER_1;
+                    break;
+
+                case STAGE_KILLER_1:
+                    stage = STAGE_KILLER_2;
+                    if (killer1 != ttMove && MoveGenerator::isLegal(board, killer1))
+                        return killer1;
+                    break;
+
+                case STAGE_KILLER_2:
+                    stage = STAGE_COUNTER_MOVE;
+                    if (killer2 != ttMove && killer2 != killer1 && MoveGenerator::isLegal(board, killer2))
+                        return killer2;
+                    break;
+
+                case STAGE_COUNTER_MOVE:
+                    stage = STAGE_GEN_QUIETS;
+                    if (counter != ttMove && counter != killer1 && counter != killer2
+                        && MoveGenerator::isLegal(board, counter))
+                        return counter;
+                    break;
+
+                case STAGE_GEN_QUIETS:
+                    moves = MoveGenerator::generateMoves(board, quietGen);
+                    for (int i = 0; i < moves.size(); i++)
+                        scores[i] = quietScore(moves[i]);
+                    cur = 0;
+                    stage = STAGE_QUIETS;
+                    break;
+
+                case STAGE_QUIETS:
+                    if (cur < moves.size()) {
+                        Move m = pickBest();
+                        if (m != ttMove && m != killer1 && m != killer2 && m != counter) return m;
+                        break;
+                    }
+                    stage = STAGE_BAD_CAPTURES;
+                    break;
+
+                case STAGE_BAD_CAPTURES:
+                    if (keepBadCaptures && badCur < badCount)
+                        return badCaptures[badCur++];
+                    stage = STAGE_DONE;
+                    break;
+
+                // In check there are only a handful of moves, so they are
+                // generated together: captures of the checker first, then
+                // king moves and blocks by history
+                case STAGE_GEN_EVASIONS:
+                    moves = MoveGenerator::generateMoves(board, EVASIONS);
+                    for (int i = 0; i < moves.size(); i++) {
+                        Move m = moves[i];
+                        if (m.flag() == CAPTURE || m.flag() == EN_PASSANT || m.flag() == PROMOTION_QUEEN)
+                            scores[i] = (1 << 30) + captureOrder(m);
+                        else
+                            scores[i] = quietScore(m);
+                    }
+                    cur = 0;
+                    stage = STAGE_EVASIONS;
+                    break;
+
+                case STAGE_EVASIONS:
+                    if (cur < moves.size()) {
+                        Move m = pickBest();
+                        if (m != ttMove) return m;
+                        break;
+                    }
+                    stage = STAGE_DONE;
+                    break;
+
+                default:
+                    return Move::none();
+            }
+        }
+    }
+
+    // no more quiet moves from now on (late move pruning)
+    void skipQuietMoves() { skipQuiets = true; }
+
+private:
+    const Board& board;
+    Move ttMove, killer1, killer2, counter;
+    const SearchThread& td; // history tables
+    const PieceToHistory* cont[2]; // continuation tables of the last two moves (nullptr if none)
+    bool evasion = false;      // in check: only the evasion stages
+    GenType quietGen = QUIETS; // what the quiet stage generates
+    bool skipQuiets = false;   // stop after the captures (quiescence, late move pruning)
+    bool keepBadCaptures = true; // false: losing captures are dropped (quiescence)
+
+    int stage = STAGE_TT_MOVE;
+    MoveList moves;          // moves of the current stage
+    int scores[MAX_MOVES];   // their ordering scores
+    int cur = 0;             // moves before `cur` were already handed out
+    Move badCaptures[MAX_MOVES]; // captures SEE says lose material, in MVV-LVA order
+    int badCount = 0, badCur = 0;
+
+    // MVV-LVA, nudged by how often this capture cut off before. Scaled so
+    // history can reorder captures of similar victims, but never puts a
+    // pawn capture ahead of taking a rook
+    int captureOrder(Move m) const {
+        return captureScore(board, m) / 8 + td.captureEntry(board, m);
+    }
+
+    // history of a quiet move, plus how well it followed the last two moves
+    int quietScore(Move m) const {
+        Piece pc = board.getPiece(m.from());
+        int score = td.history[board.turn][m.from()][m.to()];
+        for (const PieceToHistory* table : cont)
+            if (table) score += (*table)[pc][m.to()];
+        return score;
+    }
+
+    // selection step: swap the best remaining move to `cur` and return it
+    // (cheaper than sorting when we cut off after a few moves)
+    Move pickBest() {
+        int best = cur;
+        for (int i = cur + 1; i < moves.size(); i++)
+            if (scores[i] > scores[best]) best = i;
+        std::swap(moves[best], moves[cur]);
+        std::swap(scores[best], scores[cur]);
+        return moves[cur++];
+    }
+};
@@ -3,13 +3,109 @@
 #include "order.hpp"   // your eval function header
 #include "../game/movegen.hpp"      // your move generator
 #include "../game/board.hpp"      // your move generator
+#include "tt.hpp"
+#include "threads.hpp"
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
 #include <limits>
+#include <string>
 
 // -----------------------------------------
 // Constructor
 // -----------------------------------------
-Search::Search(int maxDepth) : maxDepth(maxDepth) {}
+Search::Search(const SearchLimits& limits, SearchThread& td, int threadId, const std::atomic<bool>* stopSignal)
+    : maxDepth(limits.depth > 0 ? std::min(limits.depth, MAX_PLY - 1) : MAX_PLY - 1), limits(limits),
+      td(td), threadId(threadId), stopSignal(stopSignal) {}
+
+
+// -----------------------------------------
+// Limits
+// -----------------------------------------
+void Search::checkLimits() {
+    if ((limits.nodes && nodes >= limits.nodes) || time.hardLimitReached(nodes))
+        stopped = true;
+    if (stopSignal && stopSignal->load(std::memory_order_relaxed))
+        stopped = true;
+}
+
+
+// -----------------------------------------
+// Helper thread depth skipping
+// -----------------------------------------
+// Helper i searches an iteration only when ((depth + phase) / size) is even,
+// so the helpers spread over neighbouring depths instead of all searching
+// the same one
+static const int skipSize[20]  = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+static const int skipPhase[20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+
+// -----------------------------------------
+// Forward pruning margins
+// -----------------------------------------
+// Everything the shallow pruning rules compare against, indexed by depth,
+// so the whole set can be tuned in one place. A rule only applies up to
+// the last depth in its row.
+struct PruningTable {
+    int reverseFutility[9]; // eval - margin >= beta: return eval
+    int futility[7];        // eval + margin <= alpha: skip quiet moves
+    int razoring[4];        // eval + margin < alpha: drop into quiescence
+    int lateMoveCount[9];   // quiets searched before the rest are skipped (halved when not improving)
+    int seeQuiet[9];        // quiets whose SEE is below this are skipped
+};
+
+static const PruningTable pruning = {
+    {0, 75, 150, 225, 300, 375, 450, 525, 600},
+    {0, 150, 250, 350, 450, 550, 650},
+    {0, 250, 400, 550},
+    {0, 4, 7, 12, 19, 28, 39, 52, 67},
+    {0, -50, -100, -150, -200, -250, -300, -350, -400},
+};
+
+template <size_t N>
+static constexpr int lastDepth(const int (&)[N]) { return static_cast<int>(N) - 1; }
+
+
+// -----------------------------------------
+// Late move reductions
+// -----------------------------------------
+// [depth][move number]: moves late in a well ordered list at high depth
+// rarely matter, so they get searched shallower first
+static int reductions[MAX_PLY][MAX_MOVES];
+
+static struct ReductionTableInit {
+    ReductionTableInit() {
+        for (int d = 1; d < MAX_PLY; d++)
+            for (int m = 1; m < MAX_MOVES; m++)
+                reductions[d][m] = static_cast<int>(0.75 + std::log(d) * std::log(m) / 2.25);
+    }
+} reductionTableInit;
+
+
+// -----------------------------------------
+// Mate scores in the TT
+// -----------------------------------------
+// The table stores mates as "mate in n from this node" so the entry stays
+// right when the same position shows up at another ply
+static int scoreToTT(int score, int ply) {
+    if (score >= MATE_BOUND) return score + ply;
+    if (score <= -MATE_BOUND) return score - ply;
+    return score;
+}
+
+static int scoreFromTT(int score, int ply) {
+    if (score >= MATE_BOUND) return score - ply;
+    if (score <= -MATE_BOUND) return score + ply;
+    return score;
+}
+
+// UCI score string: "cp x" or "mate n" (n in moves, negative if we get mated)
+static std::string uciScore(int score) {
+    if (score >= MATE_BOUND) return "mate " + std::to_string((MATE - score + 1) / 2);
+    if (score <= -MATE_BOUND) return "mate " + std::to_string(-(MATE + score) / 2);
+    return "cp " + std::to_string(score);
+}
 
 
 // -----------------------------------------
@@ -17,41 +113,146 @@ Search::Search(int maxDepth) : maxDepth(maxDepth) {}
 // -----------------------------------------
 SearchResult Search::findBestMove(Board& board) {
     SearchResult result;
-    result.score = -1e9;
-    result.bestMove = Move(); // default no-move
+    result.score = -INF;
+    result.bestMove = Move::none(); // default no-move
 
-    int alpha = -1e9;
-    int beta  = 1e9;
+    time.init(limits, board.turn);
+    nodes = 0;
+    stopped = false;
+    nmpMinPly = 0;
 
     // Get legal moves from root
-    std::vector<Move> moves = MoveGenerator::generateMoves(board);
+    MoveList moves = MoveGenerator::generateMoves(board);
     if (moves.empty()) { // checkmate or stalemate
-        if (board.isKingInCheck(board.turn)){
-            result.score = -1e9;
+        result.score = board.isKingInCheck(board.turn) ? -MATE : 0;
+        return result;
+    }
+
+    // Hash move first (from an earlier search of this position)
+    TTData tt;
+    if (TT.probe(board.key, tt)) {
+        for (int i = 1; i < moves.size(); i++) {
+            if (moves[i] == tt.move) {
+                std::swap(moves[0], moves[i]);
+                break;
+            }
+        }
+    }
+    result.bestMove = moves[0]; // something to play even if depth 1 runs out of time
+    td.stack[0].staticEval = board.isKingInCheck(board.turn) ? -INF : evaluate_board(board);
+
+    // --- Iterative deepening ---
+    // every iteration starts with the previous best move, so when time runs
+    // out halfway an iteration, any move that already beat it is still good
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        if (threadId > 0) {
+            int i = (threadId - 1) % 20;
+            if (((depth + skipPhase[i]) / skipSize[i]) % 2) continue;
         }
-        else{
-            result.score = 0;
+
+        // --- Aspiration window ---
+        // the score rarely moves much between iterations, so search a small
+        // window around the last one and widen it on the side that failed
+        int delta = 25;
+        int alpha = -INF, beta = INF;
+        if (depth >= 4 && std::abs(result.score) < MATE_BOUND) {
+            alpha = std::max(result.score - delta, -INF);
+            beta = std::min(result.score + delta, INF);
         }
+
+        Move bestMove = Move::none();
+        uint64_t iterationStart = nodes, bestNodes = 0;
+        int score;
+        while (true) {
+            bestMove = Move::none();
+            score = searchRoot(board, moves, depth, alpha, beta, bestMove, bestNodes);
+
+            // a move that raised alpha is trustworthy, even on a fail high
+            if (bestMove != Move::none()) {
+                result.bestMove = bestMove;
+                result.score = score;
+
+                // best move goes first in the re-search and next iteration
+                for (int i = 1; i < moves.size(); i++) {
+                    if (moves[i] == bestMove) {
+                        std::swap(moves[0], moves[i]);
+                        break;
+                    }
+                }
+            }
+            if (stopped) break;
+
+            if (score <= alpha) { // fail low: lower alpha, pull beta in
+                beta = (alpha + beta) / 2;
+                alpha = std::max(score - delta, -INF);
+            }
+            else if (score >= beta) { // fail high: raise beta
+                beta = std::min(score + delta, INF);
+            }
+            else {
+                break;
+            }
+            delta += delta / 2;
+        }
+        if (stopped) break;
+        result.depth = depth;
+        if (threadId > 0) continue; // helpers just keep going until stopped
+
+        int64_t ms = time.elapsed();
+        uint64_t totalNodes = Threads.nodesSearched();
+        std::cout << "info depth " << depth << " score " << uciScore(score)
+                  << " nodes " << totalNodes << " time " << ms
+                  << " nps " << (totalNodes * 1000 / (ms + 1)) << " hashfull " << TT.hashfull()
+                  << " pv " << bestMove.toString() << "\n" << std::flush;
+
+        double bestShare = static_cast<double>(bestNodes) / std::max<uint64_t>(1, nodes - iterationStart);
+        if (time.stopAfterIteration(depth, bestMove, score, bestShare)) break;
     }
 
-    int bestScore = -1e9;
-    Move bestMove;
-    
-    // Simple depth search loop (no iterative deepening for now)
-    for (const Move& mv : moves) {
+    return result;
+}
+
+int Search::searchRoot(Board& board, MoveList& moves, int depth, int alpha, int beta, Move& bestMove, uint64_t& bestNodes) {
+    int alphaOrig = alpha;
+    int bestScore = -INF;
+    nodes++;
+
+    for (int i = 0; i < moves.size(); i++) {
+        Move mv = moves[i];
+        uint64_t before = nodes;
+        td.stack[0].currentMove = mv;
+        td.stack[0].movedPiece = board.getPiece(mv.from());
         board.makeMove(mv);
-        int score = -negamax(board, maxDepth - 1,  1, -beta, -alpha);
+        int score;
+        if (i == 0) {
+            score = -negamax(board, depth - 1, 1, -beta, -alpha);
+        }
+        else { // PVS: prove it's no better than the best so far, re-search if it is
+            score = -negamax(board, depth - 1, 1, -alpha - 1, -alpha);
+            if (score > alpha && score < beta && !stopped)
+                score = -negamax(board, depth - 1, 1, -beta, -alpha);
+        }
         board.unmakeMove(mv);
-        std::cout<<mv.toString()<<" "<<score<<"\n";
+        if (stopped) break; // this move's score is incomplete
+
         if (score > bestScore) {
             bestScore = score;
-            bestMove = mv;
+            if (score > alpha) {
+                alpha = score;
+                bestMove = mv;
+                bestNodes = nodes - before;
+            }
         }
+        if (score >= beta) break; // fail high, the window gets widened
     }
 
-    result.bestMove = bestMove;
-    result.score = bestScore;
-    return result;
+    if (!stopped) {
+        Bound bound = bestScore >= beta ? BOUND_LOWER
+                    : bestScore > alphaOrig ? BOUND_EXACT
+                    : BOUND_UPPER;
+        TT.store(board.key, bestMove, scoreToTT(bestScore, 0), evaluate_board(board), depth, bound);
+    }
+    return bestScore;
 }
 
 
@@ -59,90 +260,251 @@ SearchResult Search::findBestMove(Board& board) {
 // Negamax with alpha-beta pruning
 // -----------------------------------------
 
-int Search::quiescence(Board& board, int alpha = -1e9, int beta = 1e9) {
-	
-    std::vector<Move> moves = MoveGenerator::generateMoves(board);
-    if (moves.empty()) { // checkmate or stalemate
-        if (board.isKingInCheck(board.turn)){
-            return -1e9;
+// true if `side` has anything besides pawns and the king (no zugzwang worries)
+static bool hasNonPawnMaterial(const Board& board, int side) {
+    uint64_t pawnsAndKing = side == WHITE ? (board.pieces[P].board | board.pieces[K].board)
+                                          : (board.pieces[p].board | board.pieces[k].board);
+    return board.occupancy[side].board & ~pawnsAndKing;
+}
+
+int Search::quiescence(Board& board, int alpha, int beta, int ply, int depth) {
+    nodes++;
+    checkLimits();
+    if (stopped) return 0;
+    bool inCheck = board.isKingInCheck(board.turn);
+    if (ply >= MAX_PLY - 1) return inCheck ? 0 : evaluate_board(board);
+    int32_t standPat = -INF;
+
+    // In check we can't stand pat: every move has to be tried
+    if (!inCheck) {
+        standPat = evaluate_board(board); // eval returns a side-to-move score
+        if (standPat >= beta) {
+            return standPat; // Opponent won't let this happen
         }
-        else{
-            return 0;
+        if (standPat > alpha) {
+            alpha = standPat; // Update alpha if we found a better score
         }
     }
-    int32_t standPat = evaluate_board(board); // eval returns a white-relative score
-	if (standPat >= beta) {
-		return standPat; // Opponent won't let this happen
-	}
-	if (standPat > alpha) {
-		alpha = standPat; // Update alpha if we found a better score
-	}
-    
-	for (Move m : moves) {
-		if (m.flag != QUIET) {
-			board.makeMove(m);
-			int score = -quiescence(board, -beta, -alpha);
-			board.unmakeMove(m);
-
-			if (score > standPat) {
-				standPat = score; // Update the best score if we found a better one
-				if (score > alpha) {
-					alpha = score;
-				}
-			}
-			if (score >= beta) {
-				return score; // Beta cutoff
-			}
-		}
-	}
-	
-	return standPat;
+
+    // Only tactical moves: captures, en passant and queen promotions that
+    // don't lose material, plus quiet checks on the first quiescence ply
+    // (every evasion in check)
+    MovePicker picker(board, Move::none(), td, ply, inCheck, depth == 0);
+    int legalMoves = 0;
+
+    Move m;
+    while ((m = picker.next()) != Move::none()) {
+        legalMoves++;
+        // quiet checks that just hang the checking piece aren't worth it
+        // (losing captures never come out of the picker here)
+        if (!inCheck && m.flag() == QUIET && !see(board, m, 0))
+            continue;
+
+        td.stack[ply].currentMove = m;
+        td.stack[ply].movedPiece = board.getPiece(m.from());
+        board.makeMove(m);
+        int score = -quiescence(board, -beta, -alpha, ply + 1, depth - 1);
+        board.unmakeMove(m);
+        if (stopped) return 0;
+
+        if (score > standPat) {
+            standPat = score; // Update the best score if we found a better one
+            if (score > alpha) {
+                alpha = score;
+            }
+        }
+        if (score >= beta) {
+            return score; // Beta cutoff
+        }
+    }
+
+    if (inCheck && legalMoves == 0) {
+        return -MATE + ply; // checkmate
+    }
+
+    return standPat;
 }
 
 int Search::negamax(Board& board, int depth, int ply, int alpha, int beta) {
-    if (depth <= 0) return quiescence(board, alpha, beta);
+    if (depth <= 0) return quiescence(board, alpha, beta, ply);
+    nodes++;
+    checkLimits();
+    if (stopped) return 0;
 
-    std::vector<Move> moves = MoveGenerator::generateMoves(board);
-    if (moves.empty()) { // checkmate or stalemate
-        if (board.isKingInCheck(board.turn)){
-            return -1e9;
-        }
-        else{
-            return 0;
+    bool inCheck = board.isKingInCheck(board.turn);
+    if (ply >= MAX_PLY - 1) return inCheck ? 0 : evaluate_board(board);
+
+    // --- Transposition table ---
+    // a deep enough entry whose bound proves the score outside the window
+    // (or exact) answers the node without searching it again
+    bool pvNode = beta - alpha > 1; // zero-window nodes only prove a bound
+    TTData tt;
+    bool ttHit = TT.probe(board.key, tt);
+    Move ttMove = ttHit ? tt.move : Move::none();
+    if (!pvNode && ttHit && tt.depth >= depth) {
+        int ttScore = scoreFromTT(tt.score, ply);
+        if (tt.bound == BOUND_EXACT ||
+            (tt.bound == BOUND_LOWER && ttScore >= beta) ||
+            (tt.bound == BOUND_UPPER && ttScore <= alpha))
+            return ttScore;
+    }
+    int staticEval = ttHit ? tt.eval : (inCheck ? 0 : evaluate_board(board));
+    td.stack[ply].staticEval = inCheck ? -INF : staticEval;
+    // better than two plies ago: pruning gets a bit more careful
+    bool improving = !inCheck && ply >= 2 && staticEval > td.stack[ply - 2].staticEval;
+
+    // --- Reverse futility pruning ---
+    // so far above beta that no quiet move of the opponent will bring it back
+    if (!pvNode && !inCheck && depth <= lastDepth(pruning.reverseFutility)
+        && std::abs(beta) < MATE_BOUND
+        && staticEval - pruning.reverseFutility[depth] >= beta)
+        return staticEval;
+
+    // --- Razoring ---
+    // hopelessly below alpha near the leaves: only tactics can save it,
+    // so let quiescence decide
+    if (!pvNode && !inCheck && depth <= lastDepth(pruning.razoring)
+        && staticEval + pruning.razoring[depth] < alpha) {
+        int value = quiescence(board, alpha - 1, alpha, ply);
+        if (stopped) return 0;
+        if (value < alpha) return value;
+    }
+
+    // --- Null move pruning ---
+    /*
+    Let the opponent move twice: if a reduced search still fails high, our
+    position is good enough that a real move will too. Not in check (passing
+    would be illegal), not at PV nodes, not twice in a row and not with only
+    pawns left, where zugzwang makes passing better than any real move.
+    */
+    if (!pvNode && !inCheck && depth >= 3 && staticEval >= beta && ply >= nmpMinPly
+        && td.stack[ply - 1].currentMove != Move::none()
+        && hasNonPawnMaterial(board, board.turn)) {
+        int R = 3 + depth / 6 + std::min((staticEval - beta) / 200, 3);
+
+        td.stack[ply].currentMove = Move::none();
+        td.stack[ply].movedPiece = NO_PIECE;
+        board.makeNullMove();
+        int nullScore = -negamax(board, depth - 1 - R, ply + 1, -beta, -beta + 1);
+        board.unmakeNullMove();
+        if (stopped) return 0;
+
+        if (nullScore >= beta) {
+            if (nullScore >= MATE_BOUND) nullScore = beta; // a mate found by passing proves nothing
+            if (depth < 12 || nmpMinPly) return nullScore;
+
+            // Deep nodes: verify with a reduced normal search, no null moves
+            // for the next plies, so a zugzwang can't cut a big subtree
+            nmpMinPly = ply + 3 * (depth - R) / 4;
+            int verify = negamax(board, depth - R, ply, beta - 1, beta);
+            nmpMinPly = 0;
+            if (verify >= beta) return nullScore;
         }
     }
 
-    orderMoves(board, moves, ply);
-    int bestValue = -1e9;
+    // moves come out one at a time: hash move, captures, killers, counter
+    // move, quiets (just the check evasions when in check)
+    MovePicker picker(board, ttMove, td, ply, inCheck);
+    int alphaOrig = alpha;
+    int bestValue = -INF;
+    Move bestMove = Move::none();
+    int legalMoves = 0;
+    Move quietsTried[MAX_MOVES]; // searched moves that didn't cut off (they get a malus)
+    Move capturesTried[MAX_MOVES];
+    int quietCount = 0, captureCount = 0;
 
-    for (const Move& mv : moves) {
+    Move mv;
+    while ((mv = picker.next()) != Move::none()) {
+        legalMoves++;
+        bool quiet = mv.flag() != CAPTURE && mv.flag() != EN_PASSANT && !mv.isPromotion();
+        bool killer = mv == td.stack[ply].killers[0] || mv == td.stack[ply].killers[1];
+        int history = quiet ? td.history[board.turn][mv.from()][mv.to()] : 0;
+
+        // --- Shallow quiet move pruning ---
+        // once one move is searched and no mate is at stake, quiet moves that
+        // don't give check can be skipped near the leaves
+        if (!pvNode && !inCheck && quiet && legalMoves > 1 && bestValue > -MATE_BOUND
+            && !MoveGenerator::givesCheck(board, mv)) {
+            // late move pruning: enough quiets searched, the rest won't help
+            if (depth <= lastDepth(pruning.lateMoveCount)
+                && quietCount >= pruning.lateMoveCount[depth] / (improving ? 1 : 2)) {
+                picker.skipQuietMoves();
+                continue;
+            }
+            // futility pruning: even a good quiet move won't lift eval above alpha
+            if (depth <= lastDepth(pruning.futility)
+                && staticEval + pruning.futility[depth] <= alpha)
+                continue;
+            // SEE pruning: the moved piece just gets taken
+            if (depth <= lastDepth(pruning.seeQuiet)
+                && !see(board, mv, pruning.seeQuiet[depth]))
+                continue;
+        }
+
+        td.stack[ply].currentMove = mv;
+        td.stack[ply].movedPiece = board.getPiece(mv.from());
         board.makeMove(mv);
-        int value = -negamax(board, depth - 1, ply+1, -beta, -alpha);
-        /*
-        if(depth==1 && mv.toString() == "d3e4"){
-            std::cout<<1<<" "<<mv.toString()<<" "<<value<<" "<<pieceSumEval(board)<<" "<<board.pieces[P].countBits()<<" "<<board.pieces[p].countBits()<<" "<<board.pieces[n].countBits()<<" "<<board.pieces[N].countBits()<<board.pieces[b].countBits()<<" "<<board.pieces[B].countBits()<<" "<<board.pieces[r].countBits()<<" "<<board.pieces[R].countBits()<<"\n";
-            board.printBoard();
+        int newDepth = depth - 1;
+        int value;
+        if (legalMoves == 1) {
+            value = -negamax(board, newDepth, ply+1, -beta, -alpha);
+        }
+        else {
+            // --- LMR ---
+            // late quiet moves first get a reduced zero-window search; less
+            // at PV nodes, for checks, killers and moves with good history
+            int r = 0;
+            if (depth >= 3 && quiet && !inCheck) {
+                r = reductions[depth][std::min(legalMoves, MAX_MOVES - 1)];
+                r -= pvNode;
+                r -= board.isKingInCheck(board.turn); // move gives check
+                r -= killer;
+                r -= std::clamp(history / 4096, 0, 2);
+                r = std::clamp(r, 0, newDepth - 1);
+            }
+
+            // PVS: zero-window scout, full window only if it beats alpha
+            value = -negamax(board, newDepth - r, ply+1, -alpha - 1, -alpha);
+            if (value > alpha && r > 0 && !stopped) // reduced move looks good: full depth
+                value = -negamax(board, newDepth, ply+1, -alpha - 1, -alpha);
+            if (value > alpha && value < beta && !stopped)
+                value = -negamax(board, newDepth, ply+1, -beta, -alpha);
         }
-        */
         board.unmakeMove(mv);
+        if (stopped) return 0; // unfinished, don't let it reach the TT
         
         if (value > bestValue) {
             bestValue = value;
+            bestMove = mv;
             if (value > alpha) {
 				alpha = value; 
 			}
         }
 
         if (value >= beta) {
-            if (mv.flag == QUIET) {
-                // QUIET move caused cutoff: record killer + history
-                addKiller(mv, ply);
-                updateHistory(mv, ply);
+            if (quiet) {
+                // quiet move caused cutoff: record killer, counter move and
+                // history, and penalize the quiets that failed before it
+                td.updateQuietStats(board, ply, mv, depth, quietsTried, quietCount);
             }
-            return bestValue; // alpha-beta cutoff
+            // the captures tried first failed either way
+            td.updateCaptureStats(board, mv, !quiet, depth, capturesTried, captureCount);
+            break; // alpha-beta cutoff
         }
+        if (quiet) quietsTried[quietCount++] = mv;
+        else capturesTried[captureCount++] = mv;
+    }
+
+    if (legalMoves == 0) { // checkmate or stalemate
+        return inCheck ? -MATE + ply : 0;
     }
 
+    Bound bound = bestValue >= beta ? BOUND_LOWER
+                : bestValue > alphaOrig ? BOUND_EXACT
+                : BOUND_UPPER;
+    // a fail-low has no real best move, keep whatever the table had
+    TT.store(board.key, bound == BOUND_UPPER ? Move::none() : bestMove,
+             scoreToTT(bestValue, ply), staticEval, depth, bound);
+
     return bestValue;
 }
-
@@ -1,30 +1,61 @@
 #ifndef SEARCH_HPP
 #define SEARCH_HPP
 
-#include <vector>
+#include <atomic>
 #include <cstdint>
 #include "../game/movegen.hpp"
 #include "../game/board.hpp"
+#include "timeman.hpp"
+#include "searchthread.hpp"
+
+// Scores: mate in n plies is MATE - n, so shorter mates score higher
+constexpr int INF = 32000;                   // outside every real score
+constexpr int MATE = 31000;                  // mate at the root
+constexpr int MATE_BOUND = MATE - MAX_PLY;   // |score| >= this means a forced mate
 
 // Result container for the search output
 struct SearchResult {
     Move bestMove;
     int score;
+    int depth = 0; // last fully searched iteration
 };
 
 class Search {
 public:
-    Search(int maxDepth);
+    // `td` holds the thread's move ordering tables. `threadId` 0 is the main
+    // thread (clock, output), others are helpers that run until `stopSignal`
+    Search(const SearchLimits& limits, SearchThread& td, int threadId = 0,
+           const std::atomic<bool>* stopSignal = nullptr);
 
     // Main entry point: finds the best move from the root position
     SearchResult findBestMove(Board& board);
 
+    uint64_t nodeCount() const { return nodes.load(std::memory_order_relaxed); }
+
 private:
     int maxDepth;
+    SearchLimits limits;
+    SearchThread& td;
+    int threadId = 0;
+    const std::atomic<bool>* stopSignal = nullptr; // shared between the threads of one search
+    alignas(64) std::atomic<uint64_t> nodes{0}; // positions visited by this search (read by the other threads)
+
+    // Stopping
+    TimeManager time;
+    bool stopped = false;  // set once a limit is hit, every node then unwinds
+    int nmpMinPly = 0;     // no null moves before this ply (null move verification)
+    void checkLimits();    // sets `stopped` when the hard time limit or nodes ran out (or on stopSignal)
+
+    // One iteration over the root moves (best move first) in the window
+    // (alpha, beta), returns the best score and sets `bestMove` to the best
+    // fully searched move that raised alpha (`bestNodes` = nodes spent below it)
+    int searchRoot(Board& board, MoveList& moves, int depth, int alpha, int beta, Move& bestMove, uint64_t& bestNodes);
 
     // Negamax search with alpha-beta pruning
-    int negamax(Board& board, int depth, int ply = 0, int alpha = 1e9, int beta = -1e9);
-    int quiescence(Board& board, int alpha, int beta);
+    int negamax(Board& board, int depth, int ply = 0, int alpha = -INF, int beta = INF);
+    // Quiescence search: only tactical moves until the position is quiet
+    // (depth counts down from 0, quiet checks are tried at depth 0 only)
+    int quiescence(Board& board, int alpha, int beta, int ply, int depth = 0);
 };
 
 #endif // SEARCH_HPP
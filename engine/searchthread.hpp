@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "../game/board.hpp"
+
+constexpr int MAX_PLY = 128; // deepest ply the search reaches
+constexpr int HISTORY_MAX = 16384; // gravity updates keep entries within +-HISTORY_MAX
+
+// piece x to square scores for quiet moves
+using PieceToHistory = int[13][64];
+
+// --- Per ply state ---
+struct SearchStack {
+    Move killers[2];  // quiet moves that caused a cutoff at this ply
+    Move currentMove; // move being searched from this ply (Move::none() = null move)
+    Piece movedPiece; // piece that makes currentMove (NO_PIECE for the null move)
+    int staticEval;   // eval of the position at this ply (-INF-like when in check)
+};
+
+// --- Per thread state ---
+/*
+Everything a search thread learns about move ordering. Each thread owns
+one and keeps it between searches, so what it learned on the last move
+helps on the next one. Aligned to a cache line so two threads' tables
+never share one.
+*/
+struct alignas(64) SearchThread {
+    int history[2][64][64];      // quiet moves: side to move x from square x to square
+    int captureHistory[13][64][7]; // captures: piece x to square x captured type (6 = none, a promotion)
+    Move counterMoves[13][64];   // quiet reply that refuted the previous move: its piece x to square
+    PieceToHistory continuation[13][64]; // quiet follow-ups: previous piece x to square, then piece x to square
+    SearchStack stack[MAX_PLY];  // indexed by ply
+
+    SearchThread() { clear(); }
+
+    // forget everything (new game)
+    void clear() {
+        std::memset(history, 0, sizeof(history));
+        std::memset(captureHistory, 0, sizeof(captureHistory));
+        std::memset(continuation, 0, sizeof(continuation));
+        for (auto& row : counterMoves)
+            for (Move& m : row)
+                m = Move::none();
+        for (SearchStack& ss : stack) {
+            ss.killers[0] = ss.killers[1] = Move::none();
+            ss.currentMove = Move::none();
+            ss.movedPiece = NO_PIECE;
+        }
+    }
+
+    // between moves: old history counts for less, killers were found at
+    // plies that now mean something else
+    void age() {
+        halve(&history[0][0][0], sizeof(history) / sizeof(int));
+        halve(&captureHistory[0][0][0], sizeof(captureHistory) / sizeof(int));
+        halve(&continuation[0][0][0][0], sizeof(continuation) / sizeof(int));
+        for (SearchStack& ss : stack)
+            ss.killers[0] = ss.killers[1] = Move::none();
+    }
+
+    // Save killer moves
+    void addKiller(Move m, int ply) {
+        Move* killers = stack[ply].killers;
+        if (killers[0] != m) {
+            killers[1] = killers[0];
+            killers[0] = m;
+        }
+    }
+
+    // continuation table for the move played `back` plies before `ply`
+    // (nullptr above the root or after a null move)
+    PieceToHistory* contHist(int ply, int back) {
+        if (ply < back || stack[ply - back].currentMove == Move::none()) return nullptr;
+        const SearchStack& ss = stack[ply - back];
+        return &continuation[ss.movedPiece][ss.currentMove.to()];
+    }
+    const PieceToHistory* contHist(int ply, int back) const {
+        return const_cast<SearchThread*>(this)->contHist(ply, back);
+    }
+
+    // the quiet move that last refuted the previous move
+    Move counterMove(int ply) const {
+        if (ply < 1 || stack[ply - 1].currentMove == Move::none()) return Move::none();
+        const SearchStack& ss = stack[ply - 1];
+        return counterMoves[ss.movedPiece][ss.currentMove.to()];
+    }
+
+    // capture history entry of `m` (a capture or queen promotion)
+    int& captureEntry(const Board& board, Move m) {
+        Piece captured = m.flag() == EN_PASSANT ? P : board.getPiece(m.to());
+        return captureHistory[board.getPiece(m.from())][m.to()][captured == NO_PIECE ? 6 : captured % 6];
+    }
+    int captureEntry(const Board& board, Move m) const {
+        return const_cast<SearchThread*>(this)->captureEntry(board, m);
+    }
+
+    // Gravity: the closer an entry already is to the bound, the less a
+    // bonus (or malus) moves it, so it stays within +-HISTORY_MAX and a
+    // change of fortune shows up quickly
+    static void gravity(int& entry, int bonus) {
+        entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+    }
+
+    // how much a cutoff at `depth` moves the tables
+    static int historyBonus(int depth) { return std::min(16 * depth * depth, 1200); }
+
+    // Quiet `best` caused a beta cutoff at `ply`; `tried` are the quiets
+    // searched before it, which didn't
+    void updateQuietStats(const Board& board, int ply, Move best, int depth, const Move* tried, int triedCount) {
+        addKiller(best, ply);
+        if (ply >= 1 && stack[ply - 1].currentMove != Move::none())
+            counterMoves[stack[ply - 1].movedPiece][stack[ply - 1].currentMove.to()] = best;
+
+        int bonus = historyBonus(depth);
+        gravity(history[board.turn][best.from()][best.to()], bonus);
+        for (int i = 0; i < triedCount; i++)
+            gravity(history[board.turn][tried[i].from()][tried[i].to()], -bonus);
+
+        for (int back = 1; back <= 2; back++) {
+            PieceToHistory* cont = contHist(ply, back);
+            if (!cont) continue;
+            gravity((*cont)[board.getPiece(best.from())][best.to()], bonus);
+            for (int i = 0; i < triedCount; i++)
+                gravity((*cont)[board.getPiece(tried[i].from())][tried[i].to()], -bonus);
+        }
+    }
+
+    // Any move caused a beta cutoff at `depth`: the captures searched before
+    // it failed, and `best` gets a bonus if it is a capture itself
+    void updateCaptureStats(const Board& board, Move best, bool bestIsCapture, int depth,
+                            const Move* tried, int triedCount) {
+        int bonus = historyBonus(depth);
+        if (bestIsCapture)
+            gravity(captureEntry(board, best), bonus);
+        for (int i = 0; i < triedCount; i++)
+            gravity(captureEntry(board, tried[i]), -bonus);
+    }
+
+private:
+    static void halve(int* entries, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            entries[i] /= 2;
+    }
+};
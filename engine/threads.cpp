@@ -0,0 +1,160 @@
+#include "threads.hpp"
+#include "tt.hpp"
+#include <iostream>
+#include <map>
+
+SearchPool Threads;
+
+SearchPool::~SearchPool(){
+    setThreads(0);
+}
+
+void SearchPool::setThreads(int n){
+    wait(); // never change threads mid-search
+
+    // shut the old threads down
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+    }
+    cv.notify_all();
+    for(auto& w : workers)
+        w->thread.join();
+    workers.clear();
+    exiting = false;
+
+    for(int i = 0; i < n; i++){
+        workers.push_back(std::make_unique<Worker>());
+        workers.back()->board = std::make_unique<Board>();
+        workers.back()->data = std::make_unique<SearchThread>();
+    }
+    for(int i = 0; i < n; i++)
+        workers[i]->thread = std::thread(&SearchPool::idleLoop, this, i);
+}
+
+void SearchPool::idleLoop(int id){
+    Worker& w = *workers[id];
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]{ return w.searching || exiting; });
+            if(exiting) return;
+        }
+
+        run(id);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            w.searching = false;
+        }
+        cv.notify_all();
+    }
+}
+
+void SearchPool::start(const Board& board, const SearchLimits& limits, bool print){
+    wait();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    TT.newSearch();
+    stopSignal = false;
+    printBestMove = print;
+
+    for(size_t i = 0; i < workers.size(); i++){
+        Worker& w = *workers[i];
+        *w.board = board;
+        w.data->age();
+
+        // helpers have no clock or node limit, the main thread stops them
+        SearchLimits threadLimits = limits;
+        if(i > 0){
+            threadLimits.wtime = threadLimits.btime = 0;
+            threadLimits.movetime = 0;
+            threadLimits.nodes = 0;
+        }
+        w.search = std::make_unique<Search>(threadLimits, *w.data, static_cast<int>(i), &stopSignal);
+        w.result = SearchResult{Move::none(), 0, 0};
+        w.searching = true;
+    }
+    cv.notify_all();
+}
+
+void SearchPool::stop(){
+    stopSignal = true;
+}
+
+void SearchPool::clear(){
+    wait();
+    for(auto& w : workers)
+        w->data->clear();
+}
+
+SearchResult SearchPool::wait(){
+    std::unique_lock<std::mutex> lock(mutex);
+    if(!workers.empty())
+        cv.wait(lock, [&]{ return !workers[0]->searching; });
+    return finalResult;
+}
+
+uint64_t SearchPool::nodesSearched() const {
+    uint64_t total = 0;
+    for(const auto& w : workers)
+        if(w->search) total += w->search->nodeCount();
+    return total;
+}
+
+void SearchPool::run(int id){
+    Worker& w = *workers[id];
+    w.result = w.search->findBestMove(*w.board);
+    if(id != 0) return;
+
+    // main thread: stop the helpers and wait for them before voting
+    stopSignal = true;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]{
+            for(size_t i = 1; i < workers.size(); i++)
+                if(workers[i]->searching) return false;
+            return true;
+        });
+    }
+
+    finalResult = vote();
+    if(printBestMove){
+        // no legal move (mate or stalemate): UCI's null move, not a1a1
+        std::string move = finalResult.bestMove == Move::none() ? "0000" : finalResult.bestMove.toString();
+        std::cout << "bestmove " << move << "\n" << std::flush;
+    }
+}
+
+// --- Voting ---
+/*
+Each thread votes for its best move, weighted by how deep it got and how
+good its score is compared to the worst thread. Deeper, better results
+from several threads agreeing beat one thread's lucky shallow result.
+*/
+SearchResult SearchPool::vote() const {
+    SearchResult best = workers[0]->result;
+    if(workers.size() == 1) return best;
+
+    int minScore = best.score;
+    for(const auto& w : workers)
+        if(w->result.depth > 0) minScore = std::min(minScore, w->result.score);
+
+    std::map<uint16_t, int64_t> votes;
+    for(const auto& w : workers)
+        if(w->result.depth > 0)
+            votes[w->result.bestMove.data] += static_cast<int64_t>(w->result.score - minScore + 14) * w->result.depth;
+
+    int64_t bestVotes = best.depth > 0 ? votes[best.bestMove.data] : -1;
+    for(const auto& w : workers){
+        const SearchResult& r = w->result;
+        if(r.depth == 0) continue;
+        int64_t v = votes.at(r.bestMove.data);
+        // more votes wins, equal votes go to the deeper search
+        if(v > bestVotes || (v == bestVotes && r.depth > best.depth)){
+            best = r;
+            bestVotes = v;
+        }
+    }
+    return best;
+}
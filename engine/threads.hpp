@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "search.hpp"
+
+// --- Lazy SMP ---
+/*
+Every thread searches the same root position with its own Board copy
+(and so its own NNUE accumulators) and its own move ordering tables. They
+only share the transposition table, which is what makes the helpers
+useful: they fill it with results the main thread then hits. Helpers skip
+some iteration depths so the threads don't all search the same tree in
+lockstep.
+
+Thread 0 is the main thread: it owns the clock. When it finishes it stops
+the helpers, and the final move is voted on by every thread that finished
+an iteration.
+*/
+class SearchPool {
+public:
+    SearchPool() { setThreads(1); }
+    ~SearchPool();
+
+    void setThreads(int n); // (re)create `n` persistent search threads
+
+    // start searching `board` in the background; `printBestMove` makes the
+    // main thread print "bestmove" when done (UCI)
+    void start(const Board& board, const SearchLimits& limits, bool printBestMove);
+    void stop();           // ask every thread to stop as soon as possible
+    void clear();          // reset every thread's search tables (ucinewgame)
+    SearchResult wait();   // block until the search is over, returns the voted result
+
+    uint64_t nodesSearched() const; // nodes of all threads in the current search
+
+private:
+    struct Worker {
+        std::thread thread;
+        std::unique_ptr<Board> board; // heap: the undo stack makes a Board large
+        std::unique_ptr<SearchThread> data; // ordering tables, kept between searches
+        std::unique_ptr<Search> search;
+        SearchResult result;
+        bool searching = false;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> stopSignal{false};
+    bool exiting = false;
+    bool printBestMove = false;
+    SearchResult finalResult;
+
+    void idleLoop(int id); // a thread waits here between searches
+    void run(int id);      // one search on thread `id`
+    SearchResult vote() const;
+};
+
+extern SearchPool Threads;
@@ -0,0 +1,67 @@
+#include "timeman.hpp"
+#include <algorithm>
+
+void TimeManager::init(const SearchLimits& limits, int side){
+    startTime = std::chrono::steady_clock::now();
+    softLimit = hardLimit = 0;
+    fixedTime = false;
+    prevBest = Move::none();
+    prevScore = 0;
+    stability = 0;
+
+    int64_t time = side == WHITE ? limits.wtime : limits.btime;
+    int64_t inc = side == WHITE ? limits.winc : limits.binc;
+
+    if(limits.movetime){
+        hardLimit = softLimit = std::max<int64_t>(1, limits.movetime - limits.moveOverhead);
+        fixedTime = true;
+        return;
+    }
+    if(!time) return; // no clock given
+
+    // what we can spend at most, keeping the overhead for every move left
+    int movesLeft = limits.movestogo ? std::min(limits.movestogo, 50) : 40;
+    int64_t available = std::max<int64_t>(1, time - limits.moveOverhead * std::min(movesLeft, 10));
+
+    // soft: an even share of the clock plus most of the increment
+    softLimit = available / movesLeft + inc * 3 / 4;
+    // hard: room to finish an unclear iteration, but never more than
+    // 3/4 of what's left (1/2 if the next control is a move away)
+    int64_t cap = limits.movestogo == 1 ? available / 2 : available * 3 / 4;
+    hardLimit = std::max<int64_t>(1, std::min(softLimit * 4, cap));
+    softLimit = std::max<int64_t>(1, std::min(softLimit, hardLimit));
+}
+
+int64_t TimeManager::elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+bool TimeManager::stopAfterIteration(int depth, Move bestMove, int score, double bestNodeShare){
+    if(!enabled()) return false;
+    int64_t ms = elapsed();
+    if(fixedTime) return ms >= hardLimit;
+
+    // Best move stability: 1.3x when it just changed, down to 0.8x
+    stability = (bestMove == prevBest) ? std::min(stability + 1, 10) : 0;
+    double stabilityScale = 1.3 - 0.05 * stability;
+
+    // Score drop since the last iteration: up to 1.5x for 50cp or more
+    int drop = (depth > 1) ? prevScore - score : 0;
+    double scoreScale = 1.0 + std::clamp(drop, 0, 50) / 100.0;
+
+    // Node share: a best move that took most of the effort is clear (0.75x at
+    // 90%), one that took little had close competition (1.5x at 30%)
+    double nodeScale = std::clamp((1.5 - bestNodeShare) * 1.25, 0.75, 1.5);
+
+    prevBest = bestMove;
+    prevScore = score;
+
+    // scaling only means something once the first iterations settled
+    double scale = depth >= 4 ? stabilityScale * scoreScale * nodeScale : 1.0;
+    int64_t soft = std::min<int64_t>(hardLimit, static_cast<int64_t>(softLimit * scale));
+
+    // the next iteration takes about as long as all previous ones together,
+    // so don't start it with less than half the budget left
+    return ms >= soft / 2;
+}
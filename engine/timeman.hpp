@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include "../game/board.hpp"
+
+// What `go` asked for (0 = not given)
+struct SearchLimits {
+    int depth = 0;          // stop after this iteration
+    int64_t wtime = 0;      // ms left on the clocks
+    int64_t btime = 0;
+    int64_t winc = 0;       // increment per move (ms)
+    int64_t binc = 0;
+    int movestogo = 0;      // moves until the next time control
+    int64_t movetime = 0;   // search exactly this long (ms)
+    uint64_t nodes = 0;     // stop after this many nodes
+    int moveOverhead = 0;   // ms kept back for lag (EngineOptions::moveOverhead)
+};
+
+// --- Time manager ---
+/*
+Two limits per move:
+  soft - checked between iterations, we don't start (or continue) deepening
+         past it. Scaled after every iteration: a best move that keeps
+         changing, a falling score or a best move that only got a small
+         share of the nodes mean the position is unclear and deserves more
+         time, a stable best move means we can move early.
+  hard - checked inside the search, the iteration is abandoned when it
+         passes. Never more than the clock minus the move overhead.
+*/
+class TimeManager {
+public:
+    // start the clock and work out the limits for `side` to move
+    void init(const SearchLimits& limits, int side);
+
+    int64_t elapsed() const; // ms since init
+
+    // cheap enough for the node loop: only reads the clock every 1024 calls
+    bool hardLimitReached(uint64_t nodes) const {
+        return hardLimit && (nodes & 1023) == 0 && elapsed() >= hardLimit;
+    }
+
+    // after a finished iteration: true if another one isn't worth starting.
+    // `bestNodeShare` = fraction of the iteration's nodes spent on the best move
+    bool stopAfterIteration(int depth, Move bestMove, int score, double bestNodeShare);
+
+    bool enabled() const { return hardLimit != 0; } // false: no clock, search to depth/nodes
+
+private:
+    std::chrono::steady_clock::time_point startTime;
+    int64_t softLimit = 0; // ms (before scaling)
+    int64_t hardLimit = 0; // ms (0 = no time limit)
+    bool fixedTime = false; // movetime: use exactly the hard limit
+
+    // what the previous iterations said
+    Move prevBest = Move::none();
+    int prevScore = 0;
+    int stability = 0; // iterations in a row with the same best move
+};
@@ -0,0 +1,123 @@
+#include "tt.hpp"
+#include <new>
+
+TranspositionTable TT;
+
+// --- Packing ---
+// data = move | score << 16 | eval << 32 | depth << 48 | (generation << 2 | bound) << 56
+static uint64_t pack(Move move, int score, int eval, int depth, uint8_t genBound){
+    return static_cast<uint64_t>(move.data)
+         | static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16
+         | static_cast<uint64_t>(static_cast<uint16_t>(eval)) << 32
+         | static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 48
+         | static_cast<uint64_t>(genBound) << 56;
+}
+
+static Move dataMove(uint64_t data){ return Move(static_cast<uint16_t>(data)); }
+static int dataScore(uint64_t data){ return static_cast<int16_t>(data >> 16); }
+static int dataEval(uint64_t data){ return static_cast<int16_t>(data >> 32); }
+static int dataDepth(uint64_t data){ return static_cast<uint8_t>(data >> 48); }
+static uint8_t dataGenBound(uint64_t data){ return static_cast<uint8_t>(data >> 56); }
+
+
+TranspositionTable::~TranspositionTable(){
+    operator delete[](buckets, std::align_val_t(alignof(Bucket)));
+}
+
+void TranspositionTable::resize(size_t mb){
+    operator delete[](buckets, std::align_val_t(alignof(Bucket)));
+    bucketCount = mb * 1024 * 1024 / sizeof(Bucket);
+    if(bucketCount == 0) bucketCount = 1;
+    buckets = static_cast<Bucket*>(operator new[](bucketCount * sizeof(Bucket), std::align_val_t(alignof(Bucket))));
+    clear();
+}
+
+void TranspositionTable::clear(){
+    for(size_t i = 0; i < bucketCount; i++){
+        for(Entry& e : buckets[i].entries){
+            e.check.store(0, std::memory_order_relaxed);
+            e.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+void TranspositionTable::newSearch(){
+    generation = (generation + 1) & 63;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData& out) const {
+    const Bucket& bucket = buckets[index(key)];
+    for(const Entry& e : bucket.entries){
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        uint64_t check = e.check.load(std::memory_order_relaxed);
+        if((check ^ data) != key || (dataGenBound(data) & 3) == BOUND_NONE)
+            continue;
+
+        out.move = dataMove(data);
+        out.score = dataScore(data);
+        out.eval = dataEval(data);
+        out.depth = dataDepth(data);
+        out.bound = static_cast<Bound>(dataGenBound(data) & 3);
+        return true;
+    }
+    return false;
+}
+
+// --- Replacement ---
+/*
+Same position: overwrite, unless the old entry is a deeper search from
+this generation and the new one isn't exact (keep the old best move if
+we have none). Otherwise replace the entry that is worth least: shallow
+entries and entries left over from earlier searches go first.
+*/
+void TranspositionTable::store(uint64_t key, Move move, int score, int eval, int depth, Bound bound){
+    Bucket& bucket = buckets[index(key)];
+    Entry* replace = nullptr;
+    int worst = 1 << 30;
+
+    for(Entry& e : bucket.entries){
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        uint64_t check = e.check.load(std::memory_order_relaxed);
+
+        if((check ^ data) == key){ // same position
+            uint8_t oldGen = dataGenBound(data) >> 2;
+            if(bound != BOUND_EXACT && oldGen == generation && dataDepth(data) > depth + 3)
+                return;
+            if(move == Move::none())
+                move = dataMove(data);
+            replace = &e;
+            break;
+        }
+
+        int age = (generation - (dataGenBound(data) >> 2)) & 63;
+        int value = dataDepth(data) - 8 * age;
+        if((dataGenBound(data) & 3) == BOUND_NONE) value = -(1 << 20); // empty slot
+        if(value < worst){
+            worst = value;
+            replace = &e;
+        }
+    }
+
+    if(depth < 0) depth = 0;
+    if(depth > 255) depth = 255;
+    uint64_t data = pack(move, score, eval, depth, static_cast<uint8_t>(generation << 2 | bound));
+    replace->data.store(data, std::memory_order_relaxed);
+    replace->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+// Sample the first 1000 entries, like other engines report it
+int TranspositionTable::hashfull() const {
+    size_t sampled = 1000 / BUCKET_SIZE;
+    if(sampled > bucketCount) sampled = bucketCount;
+
+    int used = 0;
+    for(size_t i = 0; i < sampled; i++){
+        for(const Entry& e : buckets[i].entries){
+            uint8_t genBound = dataGenBound(e.data.load(std::memory_order_relaxed));
+            if((genBound & 3) != BOUND_NONE && (genBound >> 2) == generation)
+                used++;
+        }
+    }
+    return static_cast<int>(used * 1000 / (sampled * BUCKET_SIZE));
+}
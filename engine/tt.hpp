@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "../game/board.hpp"
+
+// What a stored score says about the real score
+enum Bound : uint8_t {
+    BOUND_NONE,  // empty entry
+    BOUND_UPPER, // failed low: real score <= score
+    BOUND_LOWER, // failed high: real score >= score
+    BOUND_EXACT  // PV node: real score == score
+};
+
+// A probed entry, unpacked
+struct TTData {
+    Move move;   // best move found (Move::none() if none)
+    int score;   // search score (mate scores are relative to the stored node)
+    int eval;    // static eval of the position
+    int depth;   // depth the score was searched to
+    Bound bound;
+};
+
+// --- Transposition table ---
+/*
+One table shared by every search thread. The table is split into 64-byte
+buckets (one cache line) of 4 entries. An entry is two 64-bit words: the
+packed data and the position key XORed with that data. Reads and writes
+are relaxed atomics with no locking; if two threads write the same entry
+at once and a reader sees half of each, the XOR no longer gives back the
+key and the entry just counts as a miss.
+*/
+class TranspositionTable {
+public:
+    TranspositionTable() { resize(16); } // UCI resizes it to the Hash option
+    ~TranspositionTable();
+
+    void resize(size_t mb); // reallocate (and clear) with `mb` megabytes
+    void clear();           // forget everything (ucinewgame)
+    void newSearch();       // start a new generation, older entries age
+
+    // true (and fills `out`) if the table has an entry for `key`
+    bool probe(uint64_t key, TTData& out) const;
+    void store(uint64_t key, Move move, int score, int eval, int depth, Bound bound);
+
+    int hashfull() const; // permille of sampled entries used by the current search
+
+    // pull the bucket for `key` into cache ahead of the probe
+    void prefetch(uint64_t key) const { __builtin_prefetch(&buckets[index(key)]); }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> check; // key ^ data
+        std::atomic<uint64_t> data;  // move 16 | score 16 | eval 16 | depth 8 | generation 6 + bound 2
+    };
+
+    static constexpr int BUCKET_SIZE = 4;
+    struct alignas(64) Bucket {
+        Entry entries[BUCKET_SIZE];
+    };
+
+    Bucket* buckets = nullptr;
+    size_t bucketCount = 0;
+    uint8_t generation = 0; // 6 bits, wraps around
+
+    // map the key onto [0, bucketCount) without needing a power of two size
+    size_t index(uint64_t key) const {
+        return static_cast<size_t>((static_cast<unsigned __int128>(key) * bucketCount) >> 64);
+    }
+};
+
+extern TranspositionTable TT;
@@ -0,0 +1,185 @@
+#include "attacks.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+bool usePext = false;
+
+Magic bishopMagics[64];
+Magic rookMagics[64];
+
+uint64_t betweenBB[64][64];
+uint64_t lineBB[64][64];
+
+// Every square's attack sets live in one shared table per piece type
+// (sizes are the sum of 2^bits over all 64 masks)
+static uint64_t bishopTable[5248];
+static uint64_t rookTable[102400];
+
+
+// --- Slow ray walk (only used to build the tables) ---
+/*
+Walk each direction one square at a time until we leave the board or hit
+a blocker. The blocker square itself is included (it can be captured).
+*/
+static uint64_t slidingAttacks(int square, uint64_t occ, const int dirs[4][2]){
+    uint64_t attacks = 0ULL;
+    for(int d = 0; d < 4; d++){
+        int rank = square / 8 + dirs[d][0];
+        int file = square % 8 + dirs[d][1];
+        while(rank >= 0 && rank < 8 && file >= 0 && file < 8){
+            uint64_t bit = 1ULL << (rank * 8 + file);
+            attacks |= bit;
+            if(occ & bit) break; // blocked
+            rank += dirs[d][0];
+            file += dirs[d][1];
+        }
+    }
+    return attacks;
+}
+
+static const int bishopDirs[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+static const int rookDirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+
+// --- Pseudo random numbers for the magic search ---
+// xorshift64*, seeded per rank so the search is deterministic and quick
+struct MagicRNG {
+    uint64_t s;
+    explicit MagicRNG(uint64_t seed) : s(seed) {}
+
+    uint64_t next(){
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return s * 2685821657736338717ULL;
+    }
+
+    // few bits set = much better magic candidates
+    uint64_t sparse(){
+        return next() & next() & next();
+    }
+};
+
+
+// --- Build masks, magics and tables for one piece type ---
+static void initMagics(Magic magics[64], uint64_t* table, const int dirs[4][2]){
+    static const uint64_t seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+
+    uint64_t occupancy[4096], reference[4096];
+    int epoch[4096] = {0}, attempt = 0;
+    uint64_t* next = table;
+
+    for(int sq = 0; sq < 64; sq++){
+        Magic& m = magics[sq];
+
+        // Board edges never block (a slider always reaches them), unless
+        // the slider itself stands on that edge
+        uint64_t rank1 = 0xFFULL, rank8 = 0xFFULL << 56;
+        uint64_t fileA = 0x0101010101010101ULL, fileH = fileA << 7;
+        uint64_t edges = ((rank1 | rank8) & ~(rank1 << (8 * (sq / 8)))) |
+                         ((fileA | fileH) & ~(fileA << (sq % 8)));
+
+        m.mask = slidingAttacks(sq, 0ULL, dirs) & ~edges;
+        m.shift = 64 - __builtin_popcountll(m.mask);
+        m.magic = 0ULL;
+        m.attacks = next;
+
+        // Enumerate every subset of the mask (Carry-Rippler trick)
+        // and store the true attack set for each one
+        int size = 0;
+        uint64_t b = 0ULL;
+        do{
+            occupancy[size] = b;
+            reference[size] = slidingAttacks(sq, b, dirs);
+            size++;
+            b = (b - m.mask) & m.mask;
+        } while(b);
+        next += size;
+
+        // PEXT indices are already collision free
+        if(usePext){
+            for(int i = 0; i < size; i++)
+                m.attacks[pext(occupancy[i], m.mask)] = reference[i];
+            continue;
+        }
+
+        // Try random magics until every subset maps to a slot that is
+        // either free or already holds the same attack set
+        MagicRNG rng(seeds[sq / 8]);
+        int i;
+        do{
+            do{
+                m.magic = rng.sparse();
+            } while(__builtin_popcountll((m.mask * m.magic) >> 56) < 6);
+
+            attempt++;
+            for(i = 0; i < size; i++){
+                unsigned idx = m.index(occupancy[i]);
+                if(epoch[idx] < attempt){ // slot is unused during this attempt
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[i];
+                }
+                else if(m.attacks[idx] != reference[i]){ // bad collision
+                    break;
+                }
+            }
+        } while(i < size);
+    }
+}
+
+// --- CPU detection ---
+bool cpuHasFastPext(){
+#if defined(__x86_64__)
+    unsigned eax, ebx, ecx, edx;
+    if(__get_cpuid_max(0, nullptr) < 7) return false;
+
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    if(!(ebx & (1u << 8))) return false; // no BMI2
+
+    // Zen 1/2 implement PEXT in microcode (hundreds of cycles),
+    // magics are faster there
+    __cpuid(0, eax, ebx, ecx, edx);
+    bool amd = ebx == 0x68747541 && edx == 0x69746e65 && ecx == 0x444d4163; // "AuthenticAMD"
+    if(amd){
+        __cpuid(1, eax, ebx, ecx, edx);
+        unsigned family = (eax >> 8) & 0xF;
+        if(family == 0xF) family += (eax >> 20) & 0xFF;
+        if(family < 0x19) return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void initAttacks(bool allowPext){
+    usePext = allowPext && cpuHasFastPext();
+    initMagics(bishopMagics, bishopTable, bishopDirs);
+    initMagics(rookMagics, rookTable, rookDirs);
+
+    // Lines between squares, built from the slider tables:
+    // two squares are aligned if an empty-board slider on one sees the other
+    for(int a = 0; a < 64; a++){
+        for(int b = 0; b < 64; b++){
+            betweenBB[a][b] = lineBB[a][b] = 0ULL;
+            if(a == b) continue;
+
+            uint64_t bitA = 1ULL << a, bitB = 1ULL << b;
+            if(bishopAttacks(a, 0ULL) & bitB){
+                lineBB[a][b] = (bishopAttacks(a, 0ULL) & bishopAttacks(b, 0ULL)) | bitA | bitB;
+                betweenBB[a][b] = bishopAttacks(a, bitB) & bishopAttacks(b, bitA);
+            }
+            else if(rookAttacks(a, 0ULL) & bitB){
+                lineBB[a][b] = (rookAttacks(a, 0ULL) & rookAttacks(b, 0ULL)) | bitA | bitB;
+                betweenBB[a][b] = rookAttacks(a, bitB) & rookAttacks(b, bitA);
+            }
+        }
+    }
+}
+
+// Build the tables before main() so that every board/movegen user
+// (including the tests) can rely on them
+static struct AttackTableInit {
+    AttackTableInit(){ initAttacks(); }
+} attackTableInit;
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include "bitboard.hpp"
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// --- BMI2 ---
+// PEXT packs the blocker bits of `mask` into a dense index, which replaces
+// the multiply-shift on CPUs where it is fast. The tables are built for
+// whichever backend was picked at startup, so both share the same layout.
+extern bool usePext;
+
+inline uint64_t pext(uint64_t src, uint64_t mask){
+#if defined(__BMI2__)
+    return _pext_u64(src, mask);
+#elif defined(__x86_64__)
+    // emit the instruction directly so one portable binary can still use it
+    uint64_t result;
+    asm("pextq %2, %1, %0" : "=r"(result) : "r"(src), "r"(mask));
+    return result;
+#else
+    (void)src; (void)mask;
+    return 0; // never called, usePext stays false on other targets
+#endif
+}
+
+// Magic bitboard entry for one square
+/*
+For a slider on `square`, only the pieces on `mask` (the rays without the
+board edges) can block it. Multiplying those blockers by `magic` and keeping
+the top bits (or PEXT-ing them out) gives a unique index into that square's
+slice of the attack table.
+*/
+struct Magic {
+    uint64_t mask;     // relevant blocker squares
+    uint64_t magic;    // magic multiplier
+    uint64_t* attacks; // this square's slice of the attack table
+    int shift;         // 64 - number of bits in mask
+
+    // index of the attack set for the given occupancy
+    unsigned index(uint64_t occ) const {
+        if(usePext) return static_cast<unsigned>(pext(occ, mask));
+        return static_cast<unsigned>(((occ & mask) * magic) >> shift);
+    }
+};
+
+extern Magic bishopMagics[64];
+extern Magic rookMagics[64];
+
+// Fill masks, magics and attack tables for every square
+// (runs automatically before main, calling again is harmless)
+// `allowPext` = false forces the portable multiply-shift backend
+void initAttacks(bool allowPext = true);
+
+// true if this CPU has BMI2 and PEXT is not microcoded (pre-Zen 3 AMD)
+bool cpuHasFastPext();
+
+// Squares strictly between two aligned squares (0 if not on one line)
+extern uint64_t betweenBB[64][64];
+// Whole board line through two aligned squares, both included (0 if not aligned)
+extern uint64_t lineBB[64][64];
+
+// --- Board masks ---
+constexpr uint64_t FILE_A = 0x0101010101010101ULL;
+constexpr uint64_t FILE_B = FILE_A << 1;
+constexpr uint64_t FILE_G = FILE_A << 6;
+constexpr uint64_t FILE_H = FILE_A << 7;
+
+// --- Leaper attacks (set-wise) ---
+// every square attacked by the pawns in `pawns` (side 0 = white, 1 = black)
+constexpr uint64_t pawnAttacksBB(int side, uint64_t pawns){
+    if(side == 0)
+        return ((pawns << 7) & ~FILE_H) | ((pawns << 9) & ~FILE_A);
+    return ((pawns >> 9) & ~FILE_H) | ((pawns >> 7) & ~FILE_A);
+}
+
+// every square attacked by the knights in `knights`
+constexpr uint64_t knightAttacksBB(uint64_t knights){
+    uint64_t l1 = (knights >> 1) & ~FILE_H;
+    uint64_t l2 = (knights >> 2) & ~(FILE_G | FILE_H);
+    uint64_t r1 = (knights << 1) & ~FILE_A;
+    uint64_t r2 = (knights << 2) & ~(FILE_A | FILE_B);
+    uint64_t h1 = l1 | r1; // one file away -> two ranks up/down
+    uint64_t h2 = l2 | r2; // two files away -> one rank up/down
+    return (h1 << 16) | (h1 >> 16) | (h2 << 8) | (h2 >> 8);
+}
+
+// every square attacked by the kings in `kings`
+constexpr uint64_t kingAttacksBB(uint64_t kings){
+    uint64_t row = kings | ((kings >> 1) & ~FILE_H) | ((kings << 1) & ~FILE_A);
+    return (row | (row << 8) | (row >> 8)) & ~kings;
+}
+
+// --- Leaper attack tables (built at compile time) ---
+struct LeaperTables {
+    uint64_t pawn[2][64]; // [color][square]
+    uint64_t knight[64];
+    uint64_t king[64];
+};
+
+constexpr LeaperTables buildLeaperTables(){
+    LeaperTables t{};
+    for(int sq = 0; sq < 64; sq++){
+        uint64_t bit = 1ULL << sq;
+        t.pawn[0][sq] = pawnAttacksBB(0, bit);
+        t.pawn[1][sq] = pawnAttacksBB(1, bit);
+        t.knight[sq] = knightAttacksBB(bit);
+        t.king[sq] = kingAttacksBB(bit);
+    }
+    return t;
+}
+
+inline constexpr LeaperTables leaperTables = buildLeaperTables();
+
+// squares a `side` pawn on `square` attacks
+inline uint64_t pawnAttacks(int side, int square){ return leaperTables.pawn[side][square]; }
+// squares a knight on `square` attacks
+inline uint64_t knightAttacks(int square){ return leaperTables.knight[square]; }
+// squares a king on `square` attacks
+inline uint64_t kingAttacks(int square){ return leaperTables.king[square]; }
+
+// --- Slider attacks ---
+// squares attacked by a slider on `square` given the occupancy `occ`
+inline uint64_t bishopAttacks(int square, uint64_t occ){
+    const Magic& m = bishopMagics[square];
+    return m.attacks[m.index(occ)];
+}
+
+inline uint64_t rookAttacks(int square, uint64_t occ){
+    const Magic& m = rookMagics[square];
+    return m.attacks[m.index(occ)];
+}
+
+inline uint64_t queenAttacks(int square, uint64_t occ){
+    return bishopAttacks(square, occ) | rookAttacks(square, occ);
+}
@@ -1,4 +1,6 @@
 #include "board.hpp"
+#include "attacks.hpp"
+#include "zobrist.hpp"
 #include "../engine/nnue.hpp"
 #include <iostream>
 #include <sstream>
@@ -22,9 +24,17 @@ void Board::clear(){
     for(int i = 0; i < 3; i++)
         occupancy[i] = Bitboard(0ULL);
 
+    // Empty every square
+    for(int sq = 0; sq < 64; sq++)
+        mailbox[sq] = NO_PIECE;
+
     turn = WHITE;
     enPassantSquare = NO_SQUARE; // enum value from bitboard.hpp
     castlingRights = 0;
+    halfmoveClock = 0;
+    key = pawnKey = 0ULL;
+    checkers = pinned = 0ULL;
+    undoCount = 0;
 }
 
 int Board::calculate_index(int sq, int pt, bool side, bool perspective) {
@@ -49,63 +59,74 @@ void Board::build_accumulators(const Board& board, Accumulator& us, Accumulator&
         if (p < 6){  // white piece: P,N,B,R,Q,K = 0..5
             us.add_feature(g_net, calculate_index(sq, p, 0, 0));
             them.add_feature(g_net, calculate_index(sq, p, 0, 1));
-            std::cout<<p<<" s "<<calculate_index(sq, p, 0, 0)<<" "<<calculate_index(sq, p, 0, 1)<<"\n";
         }
         else{         // black piece: p,n,b,r,q,k = 6..11
             us.add_feature(g_net, calculate_index(sq, p-6, 1, 0));
             them.add_feature(g_net, calculate_index(sq, p-6, 1, 1));
-            std::cout<<p-6<<" "<<calculate_index(sq, p-6, 1, 0)<<" "<<calculate_index(sq, p-6, 1, 1)<<"\n";
         }
     }
-    for (int i = 0; i < 16; i++){
-        std::cout << "  [" << i << "] = " << us.vals[i] << "\n";
-    }
-    for (int i = 0; i < 16; i++){
-        std::cout << "  [" << i << "] = " << them.vals[i] << "\n";
-    }
 }
 
 
 
 // Set and Remove Pieces
+// With UpdateNNUE = false only the bitboards, mailbox and keys change, the
+// accumulators are left alone (perft, legality probes, FEN loading)
+template <bool UpdateNNUE>
 void Board::setPiece(int square, Piece piece){
     if(square < A1 || square > H8) return; // ensure valid square
     pieces[piece].setBit(square);
+    mailbox[square] = piece;
     if(piece != NO_PIECE){
-        if(piece < 6){
-            us.add_feature(g_net, calculate_index(square, p, 0, 0));
-            them.add_feature(g_net, calculate_index(square, p, 0, 1));
-        }
-        else{
-            us.add_feature(g_net, calculate_index(square, p-6, 0, 0));
-            them.add_feature(g_net, calculate_index(square, p-6, 0, 1));
+        key ^= zobrist.psq[piece][square];
+        if(piece == P || piece == p) pawnKey ^= zobrist.psq[piece][square];
+    }
+    if constexpr (UpdateNNUE){
+        if(piece != NO_PIECE){
+            if(piece < 6){
+                us.add_feature(g_net, calculate_index(square, piece, 0, 0));
+                them.add_feature(g_net, calculate_index(square, piece, 0, 1));
+            }
+            else{
+                us.add_feature(g_net, calculate_index(square, piece-6, 1, 0));
+                them.add_feature(g_net, calculate_index(square, piece-6, 1, 1));
+            }
         }
     }
 }
 
+template <bool UpdateNNUE>
 void Board::removePiece(int square, Piece piece){
     if(square < A1 || square > H8) return; // ensure valid square
     pieces[piece].clearBit(square);
+    mailbox[square] = NO_PIECE;
     if(piece != NO_PIECE){
-        if(piece < 6){
-            us.remove_feature(g_net, calculate_index(square, p, 0, 0));
-            them.remove_feature(g_net, calculate_index(square, p, 0, 1));
-        }
-        else{
-            us.remove_feature(g_net, calculate_index(square, p-6, 1, 0));
-            them.remove_feature(g_net, calculate_index(square, p-6, 1, 1));
+        key ^= zobrist.psq[piece][square];
+        if(piece == P || piece == p) pawnKey ^= zobrist.psq[piece][square];
+    }
+    if constexpr (UpdateNNUE){
+        if(piece != NO_PIECE){
+            if(piece < 6){
+                us.remove_feature(g_net, calculate_index(square, piece, 0, 0));
+                them.remove_feature(g_net, calculate_index(square, piece, 0, 1));
+            }
+            else{
+                us.remove_feature(g_net, calculate_index(square, piece-6, 1, 0));
+                them.remove_feature(g_net, calculate_index(square, piece-6, 1, 1));
+            }
         }
     }
 }
 
+template void Board::setPiece<true>(int, Piece);
+template void Board::setPiece<false>(int, Piece);
+template void Board::removePiece<true>(int, Piece);
+template void Board::removePiece<false>(int, Piece);
+
 // Get Piece at Square 
 Piece Board::getPiece(int square) const {
     if(square < A1 || square > H8) return NO_PIECE; // ensure valid square
-    for(int p = P; p <= k; p++){
-        if (pieces[p].getBit(square))
-            return static_cast<Piece>(p);
-    }
-    return NO_PIECE;
+    return mailbox[square]; // kept in sync by setPiece/removePiece
 }
 
 // Update Occupancy
@@ -125,119 +146,108 @@ void Board::updateOccupancy(){
     occupancy[BOTH].board = occupancy[WHITE].board | occupancy[BLACK].board;
 }
 
+// Compute both keys from scratch (FEN loading, debugging the incremental updates)
+void Board::computeKeys(){
+    key = pawnKey = 0ULL;
+    for(int sq = 0; sq < 64; sq++){
+        Piece pc = mailbox[sq];
+        if(pc == NO_PIECE) continue;
+        key ^= zobrist.psq[pc][sq];
+        if(pc == P || pc == p) pawnKey ^= zobrist.psq[pc][sq];
+    }
+    key ^= zobrist.castling[castlingRights];
+    if(enPassantSquare != NO_SQUARE) key ^= zobrist.enPassant[enPassantSquare % 8];
+    if(turn == BLACK) key ^= zobrist.side;
+}
+
+// --- Checkers and pins for the side to move ---
+void Board::updateCheckInfo(){
+    checkers = pinned = 0ULL;
+    uint64_t king = pieces[turn == WHITE ? K : k].board;
+    if(!king) return; // no king
+    int ksq = __builtin_ctzll(king);
+
+    uint64_t ours = occupancy[turn].board;
+    uint64_t theirs = occupancy[!turn].board;
+    checkers = attackersTo(ksq) & theirs;
+
+    // Pins: enemy sliders that would see our king if only their own pieces
+    // were on the board. If exactly one of our pieces sits in between, it's pinned
+    uint64_t theirDiag = pieces[turn == WHITE ? b : B].board | pieces[turn == WHITE ? q : Q].board;
+    uint64_t theirLine = pieces[turn == WHITE ? r : R].board | pieces[turn == WHITE ? q : Q].board;
+    uint64_t snipers = (bishopAttacks(ksq, theirs) & theirDiag) | (rookAttacks(ksq, theirs) & theirLine);
+    while(snipers){
+        int sniper = __builtin_ctzll(snipers);
+        snipers &= snipers - 1;
+
+        uint64_t blockers = betweenBB[ksq][sniper] & occupancy[BOTH].board;
+        if(blockers && !(blockers & (blockers - 1)) && (blockers & ours)) // exactly one, and it's ours
+            pinned |= blockers;
+    }
+}
+
+// every piece of either color attacking `square`, sliders blocked by `occ`
+// (callers AND with an occupancy to pick a side or drop captured pieces)
+uint64_t Board::attackersTo(int square, uint64_t occ) const {
+    uint64_t diag = pieces[B].board | pieces[b].board | pieces[Q].board | pieces[q].board;
+    uint64_t line = pieces[R].board | pieces[r].board | pieces[Q].board | pieces[q].board;
+
+    // a pawn on `square` of the other color attacks exactly the squares our attacking pawns stand on
+    return (pawnAttacks(BLACK, square) & pieces[P].board)
+         | (pawnAttacks(WHITE, square) & pieces[p].board)
+         | (knightAttacks(square) & (pieces[N].board | pieces[n].board))
+         | (kingAttacks(square) & (pieces[K].board | pieces[k].board))
+         | (bishopAttacks(square, occ) & diag)
+         | (rookAttacks(square, occ) & line);
+}
+
 // check if given square is attacked by given side
 bool Board::isSquareAttacked(int square, int bySide) const {
-    uint64_t occ = occupancy[BOTH].board; // occupancy bitboard of all pieces
+    return isSquareAttacked(square, bySide, occupancy[BOTH].board); // occupancy bitboard of all pieces
+}
+
+// same, but sliders are blocked by `occ` instead of the real occupancy
+// (e.g. with our king lifted off the board when testing its destination squares)
+bool Board::isSquareAttacked(int square, int bySide, uint64_t occ) const {
 
     // --- Pawns ---
     /*
-    A pawn attacks the square to its top left or right. By the mapping
-    of position to `square` = [0,...,63], a pawn will attack our current square
-    if its to the lower left or right of our square. This corresponds to square-7
-    and square-9 respectively for white. Thus, we check if a pawn exists there
-    by ANDing bitboard of that square with the white pawn's bitboard. For black
-    pawns, it's just the same thing but with different cooridnates (55,57,+9,+7)
-    since it's on the opposite side.
+    A pawn of `bySide` attacks our square exactly when a pawn of the other
+    color standing on our square would attack the pawn's square, so we look
+    up the opposite color's pawn attacks from `square` and AND them with the
+    attacking pawns.
     */
-    // Also must check for wrap around error
-    int file = square % 8;
-    if(bySide == WHITE){
-        if(file > 0 && square >= 9 && (pieces[P].board & (1ULL << (square - 9)))) return true;
-        if(file < 7 && square >= 7 && (pieces[P].board & (1ULL << (square - 7)))) return true;
-    }
-    else{
-        if(file < 7 && square <= 55 && (pieces[p].board & (1ULL << (square + 9)))) return true;
-        if(file > 0 && square <= 57 && (pieces[p].board & (1ULL << (square + 7)))) return true;
-    }
-
-
+    uint64_t pawns = pieces[bySide == WHITE ? P : p].board;
+    if(pawnAttacks(!bySide, square) & pawns) return true;
 
     // --- Knights ---
     uint64_t knights = pieces[bySide == WHITE ? N : n].board;
-    
-    // Offset = piece can move from square to square + Offset[i]
-    static const int knightOffsets[8] = {17, 15, 10, 6, -17, -15, -10, -6}; 
-    
-    // go through each knightOffset and check if there is an opponent knight 
-    // there that can move to our square 
-    // check out of bounds and wrap around error
-    for (int o : knightOffsets) {
-        int to = square + o;
-        if (to >= 0 && to < 64 && (knights & (1ULL << to)) && std::abs((to % 8) - (square % 8)) <= 2)
-            return true;
-    }
+    // knight moves are symmetric: squares a knight on `square` reaches hold the attacking knights
+    if(knightAttacks(square) & knights) return true;
 
     // --- King (adjacent squares) ---
     uint64_t king = pieces[bySide == WHITE ? K : k].board;
-    static const int kingOffsets[8] = {8, -8, 1, -1, 9, 7, -9, -7};
-    
-    // go through each kingOffset and check if the opponent king can 
-    // move to our square 
-    for (int o : kingOffsets) {
-        int to = square + o;
-        // check out of bounds and wrap around error
-        if (to >= 0 && to < 64 && (king & (1ULL << to)) && std::abs((to % 8) - (square % 8)) <= 1)
-            return true;
-    }
+    if(kingAttacks(square) & king) return true;
 
     // --- Diagonal attacks (bishops/queens) ---
     // Bitboard of bishops + queens
     uint64_t diagAttackers = pieces[bySide == WHITE ? B : b].board |
                              pieces[bySide == WHITE ? Q : q].board;
-    int diagDirs[4] = {9, 7, -9, -7}; // values to add or subtract to get to next square
-    
-    // Go through each direction (NE,NW,SE,SW)
-    for (int dir : diagDirs) {
-        // for each square that is on the board, that is a valid diagonal move
-        for (int sq = square + dir;
-            sq >= 0 && sq < 64 &&
-            std::abs((sq % 8) - ((sq - dir) % 8)) == 1;
-            sq += dir) {
-            // check if there is a valid attacker (bishop or queen) there
-            uint64_t mask = 1ULL << sq;
-            if (occ & mask) { // a piece is there
-                if (diagAttackers & mask){ // opponent piece
-                    return true;
-                }
-                else{ // our own piece, so we don't have to continue anymore
-                    break;
-                }
-                
-            }
-        }
-    }
+    // a bishop on our square would see exactly the squares that attack it diagonally
+    if(bishopAttacks(square, occ) & diagAttackers) return true;
 
     // --- Straight attacks (rooks/queens) ---
     // Bitboard of rooks + queens
     uint64_t lineAttackers = pieces[bySide == WHITE ? R : r].board |
                              pieces[bySide == WHITE ? Q : q].board; 
-    int lineDirs[4] = {8, -8, 1, -1}; // values to add or subtract to get to next square
-    
-    // Go through each direction (N,E,S,W)
-    for(int dir : lineDirs){
-        // for each square that is on the board, that is a valid straight move
-        for (int sq = square + dir;
-            sq >= 0 && sq < 64 &&
-            std::abs((sq % 8) - ((sq - dir) % 8)) <= 1;
-            sq += dir) {
-            // check if there is a valid attacker (rook or queen) there
-
-            if(occ & (1ULL << sq)){
-                if(lineAttackers & ( 1ULL << sq)){ // opponent piece
-                    return true;
-                }
-                else{ // our own piece, so we don't have to continue anymore
-                    break;
-                }
-            }
-        }
-    }
+    if(rookAttacks(square, occ) & lineAttackers) return true;
 
     return false; // no attacker found
 }
 
 // Check if given side's king is in check
 bool Board::isKingInCheck(int side) const{
+    if(side == turn) return checkers != 0; // cached after every move
     uint64_t kingBB = pieces[side == WHITE ? K : k].board;
     if(!kingBB) return false; // no king
     int kingSq = __builtin_ctzll(kingBB); // get bit of king's square
@@ -246,64 +256,90 @@ bool Board::isKingInCheck(int side) const{
 
 
 // Apply a move to the board
-bool Board::makeMove(const Move& move){
-    int from = move.from;
-    int to = move.to;
-    Piece piece = move.piece; // piece on current square
+template <bool UpdateNNUE>
+bool Board::makeMove(Move move){
+    int from = move.from();
+    int to = move.to();
+    MoveFlag flag = move.flag();
+    Piece piece = getPiece(from); // piece on current square
     int side = turn;
+
+    // --- Save what we are about to overwrite ---
+    UndoInfo& undo = undoStack[undoCount++];
+    undo.enPassantSquare = enPassantSquare;
+    undo.castlingRights = castlingRights;
+    undo.halfmoveClock = halfmoveClock;
+    undo.captured = NO_PIECE;
+    undo.checkers = checkers;
+    undo.pinned = pinned;
     
     // --- Reset en passant ---
+    if (enPassantSquare != NO_SQUARE)
+        key ^= zobrist.enPassant[enPassantSquare % 8];
     enPassantSquare = NO_SQUARE;
 
     // --- Handle captures ---
-    if(move.flag == CAPTURE || move.flag == EN_PASSANT){
-        int capSquare = to;
+    int capSquare = to;
 
-        // En passant capture happens right behind target (-8 or +8)
-        if (move.flag == EN_PASSANT)
-            capSquare += (side == WHITE ? -8 : 8);
+    // En passant capture happens right behind target (-8 or +8)
+    if (flag == EN_PASSANT)
+        capSquare += (side == WHITE ? -8 : 8);
 
-        Piece capturedPiece = getPiece(capSquare); 
-        if (capturedPiece != NO_PIECE)
-            removePiece(capSquare, capturedPiece);
+    Piece capturedPiece = getPiece(capSquare); // NO_PIECE for quiet moves and castling
+    if (capturedPiece != NO_PIECE){
+        removePiece<UpdateNNUE>(capSquare, capturedPiece);
+        undo.captured = capturedPiece;
     }
 
+    // --- Fifty-move counter ---
+    if (capturedPiece != NO_PIECE || piece == P || piece == p)
+        halfmoveClock = 0;
+    else
+        halfmoveClock++;
+
     // --- Move the piece ---
-    removePiece(from, piece);
-    removePiece(to, move.captured);
+    removePiece<UpdateNNUE>(from, piece);
     // --- Move logic ---
-    switch (move.flag){
+    switch (flag){
         case DOUBLE_PAWN_PUSH:
-            enPassantSquare = (side == WHITE) ? (to - 8) : (to + 8);
-            setPiece(to, piece);
+            setPiece<UpdateNNUE>(to, piece);
+            {
+                // only remember the square if an enemy pawn can actually take,
+                // otherwise identical positions would get different keys
+                int epSquare = (side == WHITE) ? (to - 8) : (to + 8);
+                if (pawnAttacks(side, epSquare) & pieces[side == WHITE ? p : P].board){
+                    enPassantSquare = epSquare;
+                    key ^= zobrist.enPassant[epSquare % 8];
+                }
+            }
             break;
 
         case KING_CASTLE:
             // move king
-            setPiece(to, piece);
+            setPiece<UpdateNNUE>(to, piece);
 
             // Move rook 
             if(to == G1){ // White kingside
-                removePiece(H1, R); 
-                setPiece(F1, R); 
+                removePiece<UpdateNNUE>(H1, R); 
+                setPiece<UpdateNNUE>(F1, R); 
             } 
             if(to == G8){ // Black kingside
-                removePiece(H8, r); 
-                setPiece(F8, r); 
+                removePiece<UpdateNNUE>(H8, r); 
+                setPiece<UpdateNNUE>(F8, r); 
             } 
             break;
         case QUEEN_CASTLE:
             // move king
-            setPiece(to, piece);
+            setPiece<UpdateNNUE>(to, piece);
 
             // Move rook
             if(to == C1){ // White queenside
-                removePiece(A1, R); 
-                setPiece(D1, R); 
+                removePiece<UpdateNNUE>(A1, R); 
+                setPiece<UpdateNNUE>(D1, R); 
             } 
             if(to == C8){ // Black queenside
-                removePiece(A8, r); 
-                setPiece(D8, r); 
+                removePiece<UpdateNNUE>(A8, r); 
+                setPiece<UpdateNNUE>(D8, r); 
             } 
             break;
 
@@ -314,23 +350,24 @@ bool Board::makeMove(const Move& move){
             {
                 // Replace pawn with new piece
                 Piece promoPiece;
-                switch(move.flag){
+                switch(flag){
                     case PROMOTION_QUEEN: promoPiece = (side == WHITE ? Q : q); break;
                     case PROMOTION_ROOK: promoPiece = (side == WHITE ? R : r); break;
                     case PROMOTION_BISHOP: promoPiece = (side == WHITE ? B : b); break;
-                    case PROMOTION_KNIGHT: promoPiece = (side == WHITE ? N : n); break;
+                    default: promoPiece = (side == WHITE ? N : n); break;
                 }
-                setPiece(to, promoPiece);
+                setPiece<UpdateNNUE>(to, promoPiece);
             }
             break;
 
         default:
             // normal
-            setPiece(to, piece);
+            setPiece<UpdateNNUE>(to, piece);
             break;
     }
 
     // --- Update castling rights ---
+    key ^= zobrist.castling[castlingRights];
     // King moved
     if (piece == K) castlingRights &= ~3;     // remove white K/Q rights
     if (piece == k) castlingRights &= ~12;    // remove black k/q rights
@@ -340,65 +377,72 @@ bool Board::makeMove(const Move& move){
     if (from == A1 || to == A1) castlingRights &= ~2; // remove white Q
     if (from == H8 || to == H8) castlingRights &= ~4; // remove black k
     if (from == A8 || to == A8) castlingRights &= ~8; // remove black q
+    key ^= zobrist.castling[castlingRights];
 
     // --- Switch side ---
     turn = (turn == WHITE ? BLACK : WHITE);
+    key ^= zobrist.side;
 
     updateOccupancy();
+    updateCheckInfo();
     return true;
 }
 
 // unmake a move to the board
-bool Board::unmakeMove(const Move& move){
-    int from = move.from;
-    int to = move.to;
-    Piece piece = move.piece; // piece on current square
-    Piece capture = move.captured;
+template <bool UpdateNNUE>
+bool Board::unmakeMove(Move move){
+    int from = move.from();
+    int to = move.to();
+    MoveFlag flag = move.flag();
     // --- Switch side ---
     turn = (turn == WHITE ? BLACK : WHITE);
+    key ^= zobrist.side;
     int side = turn;
-    
-    // --- Reset en passant ---
-    enPassantSquare = move.prevEnPassantSquare;
-    // --- Update castling rights ---
-    castlingRights = move.prevCastlingRights;
-
-    
 
-    
+    // piece that moved (a promoted piece goes back to being a pawn)
+    Piece piece = move.isPromotion() ? (side == WHITE ? P : p) : getPiece(to);
+
+    // --- Restore saved state ---
+    const UndoInfo& undo = undoStack[--undoCount];
+    Piece capture = undo.captured;
+    // swap the en passant and castling keys back (pieces are handled by set/removePiece)
+    if (enPassantSquare != NO_SQUARE) key ^= zobrist.enPassant[enPassantSquare % 8];
+    if (undo.enPassantSquare != NO_SQUARE) key ^= zobrist.enPassant[undo.enPassantSquare % 8];
+    key ^= zobrist.castling[castlingRights] ^ zobrist.castling[undo.castlingRights];
+    enPassantSquare = undo.enPassantSquare;
+    castlingRights = undo.castlingRights;
+    halfmoveClock = undo.halfmoveClock;
+    checkers = undo.checkers;
+    pinned = undo.pinned;
 
     // --- Move logic ---
-    switch (move.flag){
-        case DOUBLE_PAWN_PUSH:
-            removePiece(to, piece);
-            break;
-
+    switch (flag){
         case KING_CASTLE:
             // move king
-            removePiece(to, piece);
+            removePiece<UpdateNNUE>(to, piece);
 
             // Move rook 
             if(to == G1){ // White kingside
-                removePiece(F1, R);
-                setPiece(H1, R); 
+                removePiece<UpdateNNUE>(F1, R);
+                setPiece<UpdateNNUE>(H1, R); 
             } 
             if(to == G8){ // Black kingside
-                removePiece(F8, r); 
-                setPiece(H8, r); 
+                removePiece<UpdateNNUE>(F8, r); 
+                setPiece<UpdateNNUE>(H8, r); 
             } 
             break;
         case QUEEN_CASTLE:
             // move king
-            removePiece(to, piece);
+            removePiece<UpdateNNUE>(to, piece);
 
             // Move rook
             if(to == C1){ // White queenside
-                removePiece(D1, R);
-                setPiece(A1, R); 
+                removePiece<UpdateNNUE>(D1, R);
+                setPiece<UpdateNNUE>(A1, R); 
             } 
             if(to == C8){ // Black queenside
-                removePiece(D8, r); 
-                setPiece(A8, r); 
+                removePiece<UpdateNNUE>(D8, r); 
+                setPiece<UpdateNNUE>(A8, r); 
             } 
             break;
 
@@ -406,48 +450,73 @@ bool Board::unmakeMove(const Move& move){
         case PROMOTION_ROOK:
         case PROMOTION_BISHOP:
         case PROMOTION_KNIGHT:
-            {
-                // Replace pawn with new piece
-                Piece promoPiece;
-                switch(move.flag){
-                    case PROMOTION_QUEEN: promoPiece = (side == WHITE ? Q : q); break;
-                    case PROMOTION_ROOK: promoPiece = (side == WHITE ? R : r); break;
-                    case PROMOTION_BISHOP: promoPiece = (side == WHITE ? B : b); break;
-                    case PROMOTION_KNIGHT: promoPiece = (side == WHITE ? N : n); break;
-                }
-                removePiece(to, promoPiece);
-            }
+            // Remove the promoted piece (whatever sits on `to`)
+            removePiece<UpdateNNUE>(to, getPiece(to));
             break;
 
         default:
             // normal 
-            removePiece(to, piece);
+            removePiece<UpdateNNUE>(to, piece);
             break;
     }
 
-    setPiece(from, piece);
+    setPiece<UpdateNNUE>(from, piece);
     
     // --- Handle captures ---
-    if(move.flag == CAPTURE || move.flag == EN_PASSANT){
+    if (capture != NO_PIECE){
         int capSquare = to;
 
         // En passant capture happens right behind target (-8 or +8)
-        if (move.flag == EN_PASSANT)
+        if (flag == EN_PASSANT)
             capSquare += (side == WHITE ? -8 : 8);
 
-        if (capture != NO_PIECE)
-            setPiece(capSquare, capture);
-    }
-    else{
-        setPiece(to, capture);
+        setPiece<UpdateNNUE>(capSquare, capture);
     }
 
-    
-
     updateOccupancy();
     return true;
 }
 
+// Pass the turn without moving (only used by null move pruning)
+void Board::makeNullMove(){
+    UndoInfo& undo = undoStack[undoCount++];
+    undo.enPassantSquare = enPassantSquare;
+    undo.castlingRights = castlingRights;
+    undo.halfmoveClock = halfmoveClock;
+    undo.captured = NO_PIECE;
+    undo.checkers = checkers;
+    undo.pinned = pinned;
+
+    // en passant is only possible right after the double push
+    if (enPassantSquare != NO_SQUARE){
+        key ^= zobrist.enPassant[enPassantSquare % 8];
+        enPassantSquare = NO_SQUARE;
+    }
+    halfmoveClock++;
+
+    turn = (turn == WHITE ? BLACK : WHITE);
+    key ^= zobrist.side;
+    updateCheckInfo();
+}
+
+void Board::unmakeNullMove(){
+    const UndoInfo& undo = undoStack[--undoCount];
+    turn = (turn == WHITE ? BLACK : WHITE);
+    key ^= zobrist.side;
+
+    enPassantSquare = undo.enPassantSquare;
+    if (enPassantSquare != NO_SQUARE)
+        key ^= zobrist.enPassant[enPassantSquare % 8];
+    halfmoveClock = undo.halfmoveClock;
+    checkers = undo.checkers;
+    pinned = undo.pinned;
+}
+
+template bool Board::makeMove<true>(Move);
+template bool Board::makeMove<false>(Move);
+template bool Board::unmakeMove<true>(Move);
+template bool Board::unmakeMove<false>(Move);
+
 
 
 // Decrypt FEN and load it onto the board
@@ -486,7 +555,7 @@ void Board::loadFEN(const std::string& fen){
                 case 'q': piece = q; break;
                 case 'k': piece = k; break;
             }
-            setPiece(square, piece); // set square to this piece
+            setPiece<false>(square, piece); // set square to this piece (accumulators are rebuilt below)
             square++; // move to next square
         }
     }
@@ -501,6 +570,9 @@ void Board::loadFEN(const std::string& fen){
     if (castling.find('k') != std::string::npos) castlingRights |= 4;
     if (castling.find('q') != std::string::npos) castlingRights |= 8;
 
+    // Fifty-move counter
+    halfmoveClock = halfmove;
+
     // En passant
     if(enPassant != "-"){
         int file = enPassant[0] - 'a';
@@ -511,7 +583,18 @@ void Board::loadFEN(const std::string& fen){
         enPassantSquare = NO_SQUARE;
     }
 
+    // Same rule as makeMove: drop an en passant square no pawn can use
+    if(enPassantSquare != NO_SQUARE &&
+       !(pawnAttacks(!turn, enPassantSquare) & pieces[turn == WHITE ? P : p].board))
+        enPassantSquare = NO_SQUARE;
+
     updateOccupancy();
+    computeKeys();
+    updateCheckInfo();
+
+    // NNUE: refresh both accumulators from scratch (once the network is loaded)
+    if(g_net)
+        build_accumulators(*this, us, them);
 }
 
 // Print Board
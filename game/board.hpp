@@ -33,44 +33,60 @@ enum MoveFlag{
 
 
 
-// Represents a chess move
+// Represents a chess move packed into 16 bits:
+// bits 0-5 = from square, bits 6-11 = to square, bits 12-15 = MoveFlag
+// (the moving/captured piece is read off the board when it's needed)
 struct Move {
-    int from;           // square where the piece starts
-    int to;             // square where it moves
-    MoveFlag flag;      // special info (like CAPTURE or PROMOTION)
-    Piece piece;          // which piece moved
-    Piece captured;       // what was captured (-1 if none)
-    int prevEnPassantSquare; // store previous en passant square
-    int prevCastlingRights;
-    int score = 0;
-    // Constructor
-    Move(int from_=0, int to_=0, MoveFlag flag_=QUIET, Piece piece_=NO_PIECE, Piece captured_=NO_PIECE, int prevEnPassantSquare_ = NO_SQUARE, int prevCastlingRights_ = 0)
-        : from(from_), to(to_), flag(flag_), piece(piece_), captured(captured_), prevEnPassantSquare(prevEnPassantSquare_), prevCastlingRights(prevCastlingRights_){}
+    uint16_t data;
+
+    // Constructors
+    Move() = default; // uninitialized, so move lists are free to create
+    constexpr explicit Move(uint16_t data_) : data(data_) {}
+    constexpr Move(int from_, int to_, MoveFlag flag_ = QUIET)
+        : data(static_cast<uint16_t>(from_ | (to_ << 6) | (flag_ << 12))) {}
+
+    // "no move" (a1a1 can never be played)
+    static constexpr Move none(){ return Move(static_cast<uint16_t>(0)); }
+
+    int from() const { return data & 63; }          // square where the piece starts
+    int to() const { return (data >> 6) & 63; }     // square where it moves
+    MoveFlag flag() const { return static_cast<MoveFlag>(data >> 12); } // special info (like CAPTURE or PROMOTION)
+
+    bool isPromotion() const { return flag() >= PROMOTION_QUEEN; }
     
-    bool operator==(const Move& other) const {
-        return from == other.from &&
-            to == other.to &&
-            flag == other.flag &&
-            piece == other.piece &&
-            captured == other.captured;
-    }
+    bool operator==(const Move& other) const { return data == other.data; }
+    bool operator!=(const Move& other) const { return data != other.data; }
+
     // Convert move into UCI string format
     std::string toString() const {
-        char fromFile = 'a' + (from % 8);
-        char fromRank = '1' + (from / 8);
-        char toFile = 'a' + (to % 8);
-        char toRank = '1' + (to / 8);
+        char fromFile = 'a' + (from() % 8);
+        char fromRank = '1' + (from() / 8);
+        char toFile = 'a' + (to() % 8);
+        char toRank = '1' + (to() / 8);
         std::string ans = std::string() + fromFile + fromRank + toFile + toRank;
-        switch(flag){
+        switch(flag()){
             case PROMOTION_QUEEN: ans += 'q'; break;
             case PROMOTION_ROOK: ans += 'r'; break;
             case PROMOTION_BISHOP: ans += 'b'; break;
             case PROMOTION_KNIGHT: ans += 'n'; break;
+            default: break;
         }
         return ans;
     }
 };  
 
+// Everything makeMove overwrites that unmakeMove can't work out from the move itself
+struct UndoInfo {
+    Piece captured;      // what was captured (NO_PIECE if none)
+    int enPassantSquare; // en passant square before the move
+    int castlingRights;  // castling rights before the move
+    int halfmoveClock;   // fifty-move counter before the move
+    uint64_t checkers;   // checkers before the move
+    uint64_t pinned;     // pinned pieces before the move
+};
+
+constexpr int MAX_GAME_PLY = 2048; // game moves + search plies the undo stack can hold
+
 class Board{
 public:
 
@@ -80,6 +96,7 @@ public:
     // Bitboards
     Bitboard pieces[13]; // bitboards for all 12 pieces + empty piece
     Bitboard occupancy[3]; // Occupancy bitboards for WHITE, BLACK, BOTH
+    Piece mailbox[64]; // piece on each square (NO_PIECE if empty)
     
     Accumulator us, them;
 
@@ -88,17 +105,33 @@ public:
     Turn turn; 
     int enPassantSquare;
     int castlingRights; // 4 bits: KQkq = castle
+    int halfmoveClock; // plies since the last capture or pawn move
+
+    // Zobrist keys, kept up to date by setPiece/removePiece/makeMove/unmakeMove
+    uint64_t key;     // whole position
+    uint64_t pawnKey; // pawns only
+
+    // Check info for the side to move, refreshed after every (null) move and loadFEN
+    uint64_t checkers; // enemy pieces giving check to our king
+    uint64_t pinned;   // our pieces pinned to our king
+
+    // Undo stack (one entry per move played on this board)
+    UndoInfo undoStack[MAX_GAME_PLY];
+    int undoCount;
 
     // Constructors
     Board();
     
     // Functions
     void clear(); // clear board
-    void setPiece(int square, Piece piece); // put piece on square 
-    void removePiece(int square, Piece piece); // remove piece on square
+    // UpdateNNUE = false skips the accumulator updates (perft, legality probes)
+    template <bool UpdateNNUE = true> void setPiece(int square, Piece piece); // put piece on square 
+    template <bool UpdateNNUE = true> void removePiece(int square, Piece piece); // remove piece on square
     Piece getPiece(int square) const; // get piece at that square
 
     void updateOccupancy(); // recalculates occupancy after these updates
+    void computeKeys(); // recalculates key and pawnKey from scratch
+    void updateCheckInfo(); // recalculates checkers and pinned for the side to move
 
     // Utility
     void loadFEN(const std::string& fen); // FEN handling
@@ -108,10 +141,18 @@ public:
     void build_accumulators(const Board& board, Accumulator& white, Accumulator& black);
 
     // Moves
-    bool makeMove(const Move& move); // make move `move`
-    bool unmakeMove(const Move& move); //unmake move `move`
+    // Search uses the default NNUE-maintaining mode. makeMove<false> / unmakeMove<false>
+    // only touch bitboards and state, so they must always be paired with each other
+    template <bool UpdateNNUE = true> bool makeMove(Move move); // make move `move` (pushes an undo record)
+    template <bool UpdateNNUE = true> bool unmakeMove(Move move); // unmake move `move` (pops its undo record)
+    // Pass the turn (null move pruning): no pieces move, so the accumulators stay as they are
+    void makeNullMove();
+    void unmakeNullMove();
     // Game state
+    uint64_t attackersTo(int square, uint64_t occ) const; // every piece (both colors) attacking square, sliders blocked by occ
+    uint64_t attackersTo(int square) const { return attackersTo(square, occupancy[BOTH].board); }
     bool isSquareAttacked(int square, int bySide) const; // check if given square is attacked by given side
+    bool isSquareAttacked(int square, int bySide, uint64_t occ) const; // same, with a custom occupancy for sliders
     bool isKingInCheck(int side) const; // check if king is in check for given side
 
 };
\ No newline at end of file
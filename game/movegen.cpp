@@ -1,4 +1,5 @@
 #include "movegen.hpp"
+#include "attacks.hpp"
 #include <iostream>
 
 // --- Check if positions a and b are in the same file (vertical) ---
@@ -11,39 +12,252 @@ inline bool sameRank(int a, int b){
     return a / 8 == b / 8;
 }
 
-int MoveGenerator::currEnPassant = NO_SQUARE;       // initial value
-int MoveGenerator::currCastlingRights = 0;         // initial value
+// --- Checkers, pins and check mask ---
+// (checkers and pins are cached on the board after every move)
+MoveMasks MoveGenerator::computeMasks(const Board& board){
+    MoveMasks masks;
+    masks.checkers = board.checkers;
+    masks.pinned = board.pinned;
+    masks.checkMask = ~0ULL; // not in check: any square is fine
+
+    uint64_t king = board.pieces[board.turn == WHITE ? K : k].board;
+    masks.kingSquare = king ? __builtin_ctzll(king) : NO_SQUARE;
+
+    // Single check: capture the checker or block the ray
+    if(masks.checkers && !(masks.checkers & (masks.checkers - 1))){
+        int checker = __builtin_ctzll(masks.checkers);
+        masks.checkMask = masks.checkers | betweenBB[masks.kingSquare][checker];
+    }
+    return masks;
+}
+
+// --- Target squares for a generation type (own pieces are removed separately) ---
+static inline uint64_t typeTargets(const Board& board, GenType type){
+    if(type == CAPTURES) return board.occupancy[!board.turn].board; // enemy pieces only
+    if(type == QUIETS || type == QUIET_CHECKS) return ~board.occupancy[BOTH].board; // empty squares only
+    return ~0ULL;
+}
 
 // --- Main move generation entry ---
-std::vector<Move> MoveGenerator::generateMoves(const Board& board){
-    std::vector<Move> moves; // all moves physically possible (no king checks)
-    
+MoveList MoveGenerator::generateMoves(const Board& board, GenType type){
+    MoveList moves; // all legal moves of this type
+    MoveMasks masks = computeMasks(board);
+
+    // In check: only moves that get us out of it
+    if(masks.checkers && (type == ALL_MOVES || type == EVASIONS)){
+        generateEvasions(board, moves, masks);
+        return moves;
+    }
+
+    // Double check: only the king can move
+    if(masks.checkers & (masks.checkers - 1)){
+        generateKingMoves(board, moves, masks, type);
+        return moves;
+    }
+
     // generate all moves and store them in `moves`
-    generatePawnMoves(board, moves);
-    generateKnightMoves(board, moves);
-    generateBishopMoves(board, moves);
-    generateRookMoves(board, moves);
-    generateQueenMoves(board, moves);
-    generateKingMoves(board, moves);
-
-
-    std::vector<Move> legal; // all moves that are legal (check for king checks)
-
-    // If our king is attacked after this move, it's illegal
-    for(auto& move : moves){
-        Board copy = board; // create a copy of board
-        copy.makeMove(move); // make move 
-        if (!copy.isKingInCheck(board.turn)){ // doesn't leave king in check
-            legal.push_back(move); // move is legal
-        }  
+    // (every generator only emits moves that keep our king safe)
+    generatePawnMoves(board, moves, masks, type);
+    generateKnightMoves(board, moves, masks, type);
+    generateBishopMoves(board, moves, masks, type);
+    generateRookMoves(board, moves, masks, type);
+    generateQueenMoves(board, moves, masks, type);
+    generateKingMoves(board, moves, masks, type);
+
+    // Quiet checks: keep only the quiet moves that check the enemy king
+    if(type == QUIET_CHECKS){
+        int kept = 0;
+        for(int i = 0; i < moves.size(); i++)
+            if(givesCheck(board, moves[i]))
+                moves[kept++] = moves[i];
+        moves.count = kept;
+    }
+
+    return moves;
+}
+
+// --- Does a move give check? ---
+/*
+Play the move on copies of the bitboards only: move our piece (or the
+promoted piece / castling rook), then see whether any of our pieces
+attacks the enemy king in the resulting position. This covers direct
+checks and discovered checks (including en passant) alike.
+*/
+bool MoveGenerator::givesCheck(const Board& board, Move move){
+    int side = board.turn;
+    uint64_t enemyKing = board.pieces[side == WHITE ? k : K].board;
+    if(!enemyKing) return false;
+    int ksq = __builtin_ctzll(enemyKing);
+
+    int from = move.from(), to = move.to();
+    MoveFlag flag = move.flag();
+    Piece piece = board.getPiece(from);
+
+    // our piece type that ends up on `to`
+    int type = piece % 6;
+    switch(flag){
+        case PROMOTION_QUEEN: type = Q; break;
+        case PROMOTION_ROOK: type = R; break;
+        case PROMOTION_BISHOP: type = B; break;
+        case PROMOTION_KNIGHT: type = N; break;
+        default: break;
+    }
+
+    uint64_t occ = board.occupancy[BOTH].board;
+    uint64_t ourPieces[6];
+    for(int t = 0; t < 6; t++)
+        ourPieces[t] = board.pieces[side == WHITE ? t : t + 6].board;
+
+    // Move the piece
+    ourPieces[piece % 6] &= ~(1ULL << from);
+    ourPieces[type] |= 1ULL << to;
+    occ = (occ & ~(1ULL << from)) | (1ULL << to);
+
+    if(flag == EN_PASSANT)
+        occ &= ~(1ULL << (to + (side == WHITE ? -8 : 8)));
+
+    // Move the castling rook
+    if(flag == KING_CASTLE || flag == QUEEN_CASTLE){
+        int rookFrom = (flag == KING_CASTLE) ? to + 1 : to - 2;
+        int rookTo = (flag == KING_CASTLE) ? to - 1 : to + 1;
+        ourPieces[R] = (ourPieces[R] & ~(1ULL << rookFrom)) | (1ULL << rookTo);
+        occ = (occ & ~(1ULL << rookFrom)) | (1ULL << rookTo);
+    }
+
+    return (pawnAttacks(!side, ksq) & ourPieces[P])
+        || (knightAttacks(ksq) & ourPieces[N])
+        || (bishopAttacks(ksq, occ) & (ourPieces[B] | ourPieces[Q]))
+        || (rookAttacks(ksq, occ) & (ourPieces[R] | ourPieces[Q]));
+}
+
+// --- CHECK EVASIONS ---
+/*
+Instead of generating everything and filtering by the check mask, start
+from the few squares that resolve the check (the checker itself and the
+squares between it and our king) and look up which of our pieces reach
+them. Pinned pieces can never resolve a check, so they are skipped.
+*/
+void MoveGenerator::generateEvasions(const Board& board, MoveList& moves, const MoveMasks& masks){
+    int side = board.turn;
+
+    // King steps to squares that aren't attacked (no castling out of check)
+    generateKingMoves(board, moves, masks, EVASIONS);
+
+    // Double check: the king has to move
+    if(masks.checkers & (masks.checkers - 1)) return;
+
+    int checker = __builtin_ctzll(masks.checkers);
+    uint64_t occ = board.occupancy[BOTH].board;
+    uint64_t pawns = board.pieces[side == WHITE ? P : p].board & ~masks.pinned;
+    uint64_t knights = board.pieces[side == WHITE ? N : n].board & ~masks.pinned;
+    uint64_t diag = (board.pieces[side == WHITE ? B : b].board | board.pieces[side == WHITE ? Q : q].board) & ~masks.pinned;
+    uint64_t line = (board.pieces[side == WHITE ? R : r].board | board.pieces[side == WHITE ? Q : q].board) & ~masks.pinned;
+
+    int direction = (side == WHITE) ? 8 : -8; // pawn push direction
+    int lastRank = (side == WHITE) ? 7 : 0;
+    int doublePushRank = (side == WHITE) ? 3 : 4; // rank a double push lands on
+
+    // go through the checker square and every blocking square
+    uint64_t targets = masks.checkMask;
+    while(targets){
+        int to = __builtin_ctzll(targets);
+        targets &= targets - 1;
+        bool capture = (to == checker);
+
+        // Knights and sliders that reach `to`
+        uint64_t from = (knightAttacks(to) & knights)
+                      | (bishopAttacks(to, occ) & diag)
+                      | (rookAttacks(to, occ) & line);
+        while(from){
+            int sq = __builtin_ctzll(from);
+            from &= from - 1;
+            moves.emplace_back(sq, to, capture ? CAPTURE : QUIET);
+        }
+
+        // Pawns: capture the checker, or push onto a blocking square
+        uint64_t pawnFrom = 0ULL;
+        MoveFlag flag = capture ? CAPTURE : QUIET;
+        if(capture){
+            pawnFrom = pawnAttacks(!side, to) & pawns; // pawns attacking the checker
+        }
+        else{
+            // square a pawn pushes from (set-wise: `to` may be on our first rank)
+            uint64_t behind = side == WHITE ? (1ULL << to) >> 8 : (1ULL << to) << 8;
+            if(pawns & behind){
+                pawnFrom = behind; // single push
+            }
+            else if(to / 8 == doublePushRank && !(occ & behind) &&
+                    (pawns & (1ULL << (to - 2 * direction)))){
+                pawnFrom = 1ULL << (to - 2 * direction); // double push
+                flag = DOUBLE_PAWN_PUSH;
+            }
+        }
+        while(pawnFrom){
+            int sq = __builtin_ctzll(pawnFrom);
+            pawnFrom &= pawnFrom - 1;
+            if(to / 8 == lastRank){ // promotion
+                moves.emplace_back(sq, to, PROMOTION_QUEEN);
+                moves.emplace_back(sq, to, PROMOTION_ROOK);
+                moves.emplace_back(sq, to, PROMOTION_BISHOP);
+                moves.emplace_back(sq, to, PROMOTION_KNIGHT);
+            }
+            else{
+                moves.emplace_back(sq, to, flag);
+            }
+        }
+    }
+
+    // En passant: only helps if it takes the checking pawn (or lands on the
+    // check ray). The occupancy replay catches pins along the rank
+    if(board.enPassantSquare != NO_SQUARE){
+        int epTarget = board.enPassantSquare;
+        int capSquare = epTarget - direction;
+        if(capSquare == checker || (masks.checkMask & (1ULL << epTarget))){
+            uint64_t theirDiag = board.pieces[side == WHITE ? b : B].board | board.pieces[side == WHITE ? q : Q].board;
+            uint64_t theirLine = board.pieces[side == WHITE ? r : R].board | board.pieces[side == WHITE ? q : Q].board;
+            uint64_t leaperCheckers = masks.checkers & ~(theirDiag | theirLine) & ~(1ULL << capSquare);
+
+            uint64_t epFrom = pawnAttacks(!side, epTarget) & board.pieces[side == WHITE ? P : p].board;
+            while(epFrom){
+                int sq = __builtin_ctzll(epFrom);
+                epFrom &= epFrom - 1;
+                uint64_t occAfter = (occ ^ (1ULL << sq) ^ (1ULL << capSquare)) | (1ULL << epTarget);
+                if(leaperCheckers ||
+                   (bishopAttacks(masks.kingSquare, occAfter) & theirDiag) ||
+                   (rookAttacks(masks.kingSquare, occAfter) & theirLine))
+                    continue;
+                moves.emplace_back(sq, epTarget, EN_PASSANT);
+            }
+        }
+    }
+}
+
+// --- Legality check for a move from somewhere else ---
+bool MoveGenerator::isLegal(const Board& board, Move move){
+    if(move == Move::none()) return false;
+
+    Piece piece = board.getPiece(move.from());
+    if(piece == NO_PIECE || (piece < 6) != (board.turn == WHITE)) return false; // not our piece
+
+    // only generate moves for the piece type that would move
+    MoveList moves;
+    MoveMasks masks = computeMasks(board);
+    bool doubleCheck = masks.checkers & (masks.checkers - 1);
+    switch(piece % 6){
+        case P: if(!doubleCheck) generatePawnMoves(board, moves, masks, ALL_MOVES); break;
+        case N: if(!doubleCheck) generateKnightMoves(board, moves, masks, ALL_MOVES); break;
+        case B: if(!doubleCheck) generateBishopMoves(board, moves, masks, ALL_MOVES); break;
+        case R: if(!doubleCheck) generateRookMoves(board, moves, masks, ALL_MOVES); break;
+        case Q: if(!doubleCheck) generateQueenMoves(board, moves, masks, ALL_MOVES); break;
+        default: generateKingMoves(board, moves, masks, ALL_MOVES); break;
     }
-    return legal;
+    for(Move m : moves)
+        if(m == move) return true;
+    return false;
 }
 
 // --- PAWN MOVES ---
-void MoveGenerator::generatePawnMoves(const Board& board, std::vector<Move>& moves){
-    currEnPassant = board.enPassantSquare;
-    currCastlingRights = board.castlingRights;
+void MoveGenerator::generatePawnMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type){
     Turn side = board.turn;
     // bitboard of all pawns (board.pieces[P] = bitboard, so we do bitboard.board to get the bitboard value) 
     uint64_t pawns = board.pieces[side == WHITE ? P : p].board;  
@@ -54,73 +268,96 @@ void MoveGenerator::generatePawnMoves(const Board& board, std::vector<Move>& mov
     int startRank = (side == WHITE) ? 1 : 6; // start rank of pawn (0 indexed)
     int promotionRank = (side == WHITE) ? 6 : 1; // rank before promotion
 
+    // queen promotions count as captures (tactical), underpromotions as quiets
+    bool wantCaptures = type != QUIETS && type != QUIET_CHECKS;
+    bool wantQuiets = type != CAPTURES;
+
     
     // go though all pawns
     while(pawns){ // after going through all pawns, pawns bitboard = 0
         int from = __builtin_ctzll(pawns); // get index of least significant bit (pawn square)
         pawns &= pawns - 1; // clear least significant b
 
+        // squares this pawn may land on without exposing our king
+        uint64_t allowed = masks.checkMask;
+        if(masks.pinned & (1ULL << from)) // pinned pawns stay on the pin line
+            allowed &= lineBB[masks.kingSquare][from];
+
         int to = from + direction; // move one to direction
 
         // move up 1 square
         if(!(board.occupancy[BOTH].board & (1ULL << to))){ // front square not occupied
-            // Promotion
-            if(from / 8 == promotionRank){ // if its at rank before promotion
-                // Add four promotion options
-                moves.emplace_back(from, to, PROMOTION_QUEEN, (side == WHITE ? P : p), NO_PIECE, currEnPassant, currCastlingRights);
-                moves.emplace_back(from, to, PROMOTION_ROOK, (side == WHITE ? P : p), NO_PIECE, currEnPassant, currCastlingRights);
-                moves.emplace_back(from, to, PROMOTION_BISHOP, (side == WHITE ? P : p), NO_PIECE, currEnPassant, currCastlingRights);
-                moves.emplace_back(from, to, PROMOTION_KNIGHT, (side == WHITE ? P : p), NO_PIECE, currEnPassant, currCastlingRights);
-            }
-            else{ // doesn't promote
-                moves.emplace_back(from, to, QUIET, (side == WHITE ? P : p), NO_PIECE, currEnPassant, currCastlingRights);
+            if(allowed & (1ULL << to)){ // keeps our king safe
+                // Promotion
+                if(from / 8 == promotionRank){ // if its at rank before promotion
+                    // Add four promotion options
+                    if(wantCaptures){
+                        moves.emplace_back(from, to, PROMOTION_QUEEN);
+                    }
+                    if(wantQuiets){
+                        moves.emplace_back(from, to, PROMOTION_ROOK);
+                        moves.emplace_back(from, to, PROMOTION_BISHOP);
+                        moves.emplace_back(from, to, PROMOTION_KNIGHT);
+                    }
+                }
+                else if(wantQuiets){ // doesn't promote
+                    moves.emplace_back(from, to, QUIET);
+                }
             }
 
             // Double push
-            if(from / 8 == startRank){ // its at starting rank, double pushed allowed
+            if(wantQuiets && from / 8 == startRank){ // its at starting rank, double pushed allowed
                 int doubleTo = from + 2 * direction; // square after double pushing
-                if(!(board.occupancy[BOTH].board & (1ULL << doubleTo))){ // front two squares not occupied 
-                    moves.emplace_back(from, doubleTo, DOUBLE_PAWN_PUSH, (side == WHITE ? P : p), NO_PIECE, currEnPassant, currCastlingRights);
+                if(!(board.occupancy[BOTH].board & (1ULL << doubleTo)) && (allowed & (1ULL << doubleTo))){ // front two squares not occupied 
+                    moves.emplace_back(from, doubleTo, DOUBLE_PAWN_PUSH);
                 }
             }
         }
 
-        // Captures
-        for(int captureDir : {7, 9}){
-            int toCap = (side == WHITE) ? from + captureDir : from - captureDir; // capture by side
-            // wrap around error
-            int fromFile = from % 8;
-            int toFile = toCap % 8;
-
-            if(toCap < 0 || toCap >= 64 || abs(toFile - fromFile) > 1) continue; // capture is invalid (goes out of board)
-            if(board.occupancy[!side].board & (1ULL << toCap)){ // there exists piece for capture
-                
-                // Capture + promotion
-                if(from / 8 == promotionRank){ // if its at rank before promotion
-                    // Add four promotion options
-                    moves.emplace_back(from, toCap, PROMOTION_QUEEN, (side == WHITE ? P : p), board.getPiece(toCap), currEnPassant, currCastlingRights);
-                    moves.emplace_back(from, toCap, PROMOTION_ROOK, (side == WHITE ? P : p), board.getPiece(toCap), currEnPassant, currCastlingRights);
-                    moves.emplace_back(from, toCap, PROMOTION_BISHOP, (side == WHITE ? P : p), board.getPiece(toCap), currEnPassant, currCastlingRights);
-                    moves.emplace_back(from, toCap, PROMOTION_KNIGHT, (side == WHITE ? P : p), board.getPiece(toCap), currEnPassant, currCastlingRights);
+        // Captures: enemy pieces on the pawn's attack squares
+        uint64_t captures = pawnAttacks(side, from) & board.occupancy[!side].board & allowed;
+        while(captures){
+            int toCap = __builtin_ctzll(captures);
+            captures &= captures - 1;
+
+            // Capture + promotion
+            if(from / 8 == promotionRank){ // if its at rank before promotion
+                // Add four promotion options
+                if(wantCaptures){
+                    moves.emplace_back(from, toCap, PROMOTION_QUEEN);
                 }
-                else{
-                    moves.emplace_back(from, toCap, CAPTURE, (side == WHITE ? P : p), board.getPiece(toCap), currEnPassant, currCastlingRights);
+                if(wantQuiets){
+                    moves.emplace_back(from, toCap, PROMOTION_ROOK);
+                    moves.emplace_back(from, toCap, PROMOTION_BISHOP);
+                    moves.emplace_back(from, toCap, PROMOTION_KNIGHT);
                 }
             }
+            else if(wantCaptures){
+                moves.emplace_back(from, toCap, CAPTURE);
+            }
         }
 
 
         // En passant
-        if(board.enPassantSquare != NO_SQUARE){
+        if(wantCaptures && board.enPassantSquare != NO_SQUARE){
             int epTarget = board.enPassantSquare;
-            int leftCap = (side == WHITE) ? from + 7 : from - 9; // top left pawn square
-            int rightCap = (side == WHITE) ? from + 9 : from - 7; // top right pawn square
-            // wrap around error
-            int fromFile = from % 8;
-            int toFile = epTarget % 8;
-            if(epTarget < 0 || epTarget >= 64 || abs(toFile - fromFile) > 1) continue;
-            if(epTarget == leftCap || epTarget == rightCap){ // enPassant exists at square
-                moves.emplace_back(from, epTarget, EN_PASSANT, (side == WHITE ? P : p), (side == WHITE ? p : P), currEnPassant, currCastlingRights); 
+            if(pawnAttacks(side, from) & (1ULL << epTarget)){ // enPassant exists at square
+                // En passant removes two pawns from one rank at once, so pins and
+                // checks can't be read off the masks. Replay the occupancy instead:
+                // the king must not see an enemy slider afterwards, and any pawn or
+                // knight check has to be the pawn we are capturing
+                int capSquare = epTarget + (side == WHITE ? -8 : 8);
+                if(masks.kingSquare != NO_SQUARE){
+                    uint64_t occAfter = (board.occupancy[BOTH].board ^ (1ULL << from) ^ (1ULL << capSquare)) | (1ULL << epTarget);
+                    uint64_t theirDiag = board.pieces[side == WHITE ? b : B].board | board.pieces[side == WHITE ? q : Q].board;
+                    uint64_t theirLine = board.pieces[side == WHITE ? r : R].board | board.pieces[side == WHITE ? q : Q].board;
+                    uint64_t leaperCheckers = masks.checkers & ~(theirDiag | theirLine) & ~(1ULL << capSquare);
+                    if(leaperCheckers ||
+                       (bishopAttacks(masks.kingSquare, occAfter) & theirDiag) ||
+                       (rookAttacks(masks.kingSquare, occAfter) & theirLine))
+                        continue;
+                }
+                moves.emplace_back(from, epTarget, EN_PASSANT); 
             }
         }
 
@@ -129,39 +366,29 @@ void MoveGenerator::generatePawnMoves(const Board& board, std::vector<Move>& mov
 
 
 // --- KNIGHT MOVES ---
-void MoveGenerator::generateKnightMoves(const Board& board, std::vector<Move>& moves) {
-    currEnPassant = board.enPassantSquare;
-    currCastlingRights = board.castlingRights;
+void MoveGenerator::generateKnightMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type) {
     Turn side = board.turn;
     uint64_t knights = board.pieces[side == WHITE ? N : n].board;
-    
-    // Knight move offsets (in board index difference)
-    int knightOffsets[8] = {17, 15, 10, 6, -6, -10, -15, -17};
 
-    // go through all knights
+    // go through all knights (a pinned knight can never move)
+    knights &= ~masks.pinned;
     while(knights){
         // delete knight
         int from = __builtin_ctzll(knights);
         knights &= knights - 1;
 
-        // go through each direction
-        for(int offset : knightOffsets){
-            int to = from + offset; // square it can go to
-
-            // Skip if out of bounds (like wrapping from left to right)
-            int fromFile = from % 8;
-            int toFile = to % 8;
-            if(to < 0 || to >= 64 || abs(toFile - fromFile) > 2)
-                continue;
-
-            // Cannot move into own piece
-            if(board.occupancy[side].board & (1ULL << to)) continue;
+        // every square the knight jumps to, minus our own pieces,
+        // and it must resolve a check if there is one
+        uint64_t targets = knightAttacks(from) & ~board.occupancy[side].board & masks.checkMask & typeTargets(board, type);
+        while(targets){
+            int to = __builtin_ctzll(targets);
+            targets &= targets - 1;
 
             // Capture or quiet
             if(board.occupancy[!side].board & (1ULL << to))
-                moves.emplace_back(from, to, CAPTURE, (side == WHITE ? N : n), board.getPiece(to), currEnPassant, currCastlingRights);
+                moves.emplace_back(from, to, CAPTURE);
             else
-                moves.emplace_back(from, to, QUIET, (side == WHITE ? N : n), NO_PIECE, currEnPassant, currCastlingRights);
+                moves.emplace_back(from, to, QUIET);
         }
     }
 }
@@ -169,10 +396,7 @@ void MoveGenerator::generateKnightMoves(const Board& board, std::vector<Move>& m
 
 
 // --- BISHOP MOVES ---
-void MoveGenerator::generateBishopMoves(const Board& board, std::vector<Move>& moves){
-    currEnPassant = board.enPassantSquare;
-    currCastlingRights = board.castlingRights;
-    int directions[4] = {9, 7, -9, -7};
+void MoveGenerator::generateBishopMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type){
     Turn side = board.turn;
     uint64_t bishops = board.pieces[side == WHITE ? B : b].board;
 
@@ -182,45 +406,26 @@ void MoveGenerator::generateBishopMoves(const Board& board, std::vector<Move>& m
         int from = __builtin_ctzll(bishops);
         bishops &= bishops - 1;
 
-        //go that direction until end
-        for(int dir : directions){
-            int to = from;
-
-            // go that direction until end
-            while(true){
-                int next = to + dir;
-
-                // Break if out of board range
-                if(next < 0 || next >= 64)
-                    break;
-
-                // Prevent wrapping across files
-                int fromFile = to % 8;
-                int toFile = next % 8;
-                if(abs(toFile - fromFile) > 1)
-                    break;
-
-                if(board.occupancy[side].board & (1ULL << next)) // blocked by own piece
-                    break; 
-
-                if(board.occupancy[!side].board & (1ULL << next)){ // can capture piece
-                    moves.emplace_back(from, next, CAPTURE, (side == WHITE ? B : b), board.getPiece(next), currEnPassant, currCastlingRights);
-                    break; // stop after capture
-                }
-
-                moves.emplace_back(from, next, QUIET, (side == WHITE ? B : b), NO_PIECE, currEnPassant, currCastlingRights); // add move
-                to = next; // go to next move
-            }
+        // every square the bishop sees, minus our own pieces
+        uint64_t targets = bishopAttacks(from, board.occupancy[BOTH].board) & ~board.occupancy[side].board;
+        targets &= masks.checkMask & typeTargets(board, type);
+        if(masks.pinned & (1ULL << from)) // pinned: slide along the pin line only
+            targets &= lineBB[masks.kingSquare][from];
+        while(targets){
+            int to = __builtin_ctzll(targets);
+            targets &= targets - 1;
+
+            if(board.occupancy[!side].board & (1ULL << to)) // can capture piece
+                moves.emplace_back(from, to, CAPTURE);
+            else
+                moves.emplace_back(from, to, QUIET);
         }
     }
 }
 
 
 // --- ROOK MOVES ---
-void MoveGenerator::generateRookMoves(const Board& board, std::vector<Move>& moves){
-    currEnPassant = board.enPassantSquare;
-    currCastlingRights = board.castlingRights;
-    int directions[4] = {8, -8, 1, -1}; // only horizontal
+void MoveGenerator::generateRookMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type){
     int side = board.turn;
     uint64_t rooks = board.pieces[side == WHITE ? R : r].board;
 
@@ -230,33 +435,19 @@ void MoveGenerator::generateRookMoves(const Board& board, std::vector<Move>& mov
         int from = __builtin_ctzll(rooks);
         rooks &= rooks - 1;
 
-        // go through all directions
-        for(int dir : directions){
-            int to = from;
-
-            // go that direction until end
-            while(true){
-                int next = to + dir;
-
-                // Out of board
-                if(next < 0 || next >= 64)
-                    break;
-
-                // Prevent horizontal wrap
-                if((dir == 1 || dir == -1) && (next / 8 != to / 8))
-                    break;
-
-                if(board.occupancy[side].board & (1ULL << next)) // blocked by own piece
-                    break;
-
-                if(board.occupancy[!side].board & (1ULL << next)) { // can capture piece
-                    moves.emplace_back(from, next, CAPTURE, (side == WHITE ? R : r), board.getPiece(next), board.enPassantSquare, currCastlingRights);
-                    break;
-                }
-
-                moves.emplace_back(from, next, QUIET, (side == WHITE ? R : r), NO_PIECE, currEnPassant, currCastlingRights); // add move
-                to = next; // go to next move
-            }
+        // every square the rook sees, minus our own pieces
+        uint64_t targets = rookAttacks(from, board.occupancy[BOTH].board) & ~board.occupancy[side].board;
+        targets &= masks.checkMask & typeTargets(board, type);
+        if(masks.pinned & (1ULL << from)) // pinned: slide along the pin line only
+            targets &= lineBB[masks.kingSquare][from];
+        while(targets){
+            int to = __builtin_ctzll(targets);
+            targets &= targets - 1;
+
+            if(board.occupancy[!side].board & (1ULL << to)) // can capture piece
+                moves.emplace_back(from, to, CAPTURE);
+            else
+                moves.emplace_back(from, to, QUIET);
         }
     }
 }
@@ -265,10 +456,7 @@ void MoveGenerator::generateRookMoves(const Board& board, std::vector<Move>& mov
 
 
 // --- QUEEN MOVES ---
-void MoveGenerator::generateQueenMoves(const Board& board, std::vector<Move>& moves){
-    currEnPassant = board.enPassantSquare;
-    currCastlingRights = board.castlingRights;
-    int directions[8] = {8, -8, 1, -1, 9, 7, -9, -7}; // all 8 directions
+void MoveGenerator::generateQueenMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type){
     int side = board.turn;
     uint64_t queens = board.pieces[side == WHITE ? Q : q].board;
 
@@ -278,67 +466,47 @@ void MoveGenerator::generateQueenMoves(const Board& board, std::vector<Move>& mo
         int from = __builtin_ctzll(queens);
         queens &= queens - 1;
 
-        // go through all directions
-        for(int dir : directions){
-            int to = from;
-
-            // go that direction until end
-            while(true){
-                int next = to + dir;
-
-                if(next < 0 || next >= 64) // not on board
-                    break;
-
-                // Horizontal wrap check
-                if((dir == 1 || dir == -1 || dir == 7 || dir == 9 || dir == -7 || dir == -9) &&
-                    abs((next % 8) - (to % 8)) > 1)
-                    break;
-
-                if(board.occupancy[side].board & (1ULL << next)) // blocked by own piece
-                    break;
-
-                if(board.occupancy[!side].board & (1ULL << next)){ // capture opposite piece
-                    moves.emplace_back(from, next, CAPTURE, (side == WHITE ? Q : q), board.getPiece(next), currEnPassant, currCastlingRights);
-                    break; 
-                }
-
-                moves.emplace_back(from, next, QUIET, (side == WHITE ? Q : q), NO_PIECE, currEnPassant, currCastlingRights); // move to square
-                to = next; // next square in that direction
-            }
+        // bishop + rook rays, minus our own pieces
+        uint64_t targets = queenAttacks(from, board.occupancy[BOTH].board) & ~board.occupancy[side].board;
+        targets &= masks.checkMask & typeTargets(board, type);
+        if(masks.pinned & (1ULL << from)) // pinned: slide along the pin line only
+            targets &= lineBB[masks.kingSquare][from];
+        while(targets){
+            int to = __builtin_ctzll(targets);
+            targets &= targets - 1;
+
+            if(board.occupancy[!side].board & (1ULL << to)) // capture opposite piece
+                moves.emplace_back(from, to, CAPTURE);
+            else
+                moves.emplace_back(from, to, QUIET);
         }
     }
 }
 
 
 // --- KING MOVES ---
-void MoveGenerator::generateKingMoves(const Board& board, std::vector<Move>& moves){
-    currEnPassant = board.enPassantSquare;
-    currCastlingRights = board.castlingRights;
+void MoveGenerator::generateKingMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type){
     int side = board.turn;
     uint64_t king = board.pieces[side == WHITE ? K : k].board;
 
     if (!king) return; // no king
 
     int from = __builtin_ctzll(king); // `from` square 
-    int directions[8] = {8, -8, 1, -1, 9, 7, -9, -7}; // offsets
-
-    // go through all 8 directions
-    for(int dir : directions){
-        int to = from + dir;
-
-        if (to < 0 || to >= 64) continue;
 
-        // Prevent wrapping horizontally
-        int fromFile = from % 8;
-        int toFile = to % 8;
-        if (abs(toFile - fromFile) > 1) continue; // invalid move
+    // go through all neighbouring squares that aren't our own pieces
+    uint64_t targets = kingAttacks(from) & ~board.occupancy[side].board & typeTargets(board, type);
+    while(targets){
+        int to = __builtin_ctzll(targets);
+        targets &= targets - 1;
 
-        if (board.occupancy[side].board & (1ULL << to)) continue; // can't land on own piece
+        // can't step onto an attacked square (lift the king off the board first,
+        // otherwise it would hide the squares behind it on a checking ray)
+        if (board.isSquareAttacked(to, !side, board.occupancy[BOTH].board & ~king)) continue;
 
         if (board.occupancy[!side].board & (1ULL << to)) // can capture piece
-            moves.emplace_back(from, to, CAPTURE, (side == WHITE ? K : k), board.getPiece(to), currEnPassant, currCastlingRights);
+            moves.emplace_back(from, to, CAPTURE);
         else // moves there, no piece to capture
-            moves.emplace_back(from, to, QUIET, (side == WHITE ? K : k), NO_PIECE, currEnPassant, currCastlingRights);
+            moves.emplace_back(from, to, QUIET);
     }
 
 
@@ -346,39 +514,45 @@ void MoveGenerator::generateKingMoves(const Board& board, std::vector<Move>& mov
     // --- CASTLING ---
     uint64_t all = board.occupancy[BOTH].board;
 
-    if(side == WHITE && !board.isKingInCheck(WHITE)){ // king can't castle in check
+    if(masks.checkers || type == CAPTURES) return; // king can't castle in check
+
+    // the squares the king crosses must not be attacked either
+    uint64_t theirs = board.occupancy[!side].board;
+    auto attacked = [&](int square){ return (board.attackersTo(square, all) & theirs) != 0; };
+
+    if(side == WHITE){
         // Kingside (K)
         if(board.castlingRights & 1){
             if(!(all & ((1ULL << F1) | (1ULL << G1))) &&
-                (!board.isSquareAttacked(F1, !side) 
-              && !board.isSquareAttacked(G1, !side))){ // castling path is empty and not attacked
-                moves.emplace_back(E1, G1, KING_CASTLE, K, NO_PIECE, currEnPassant, currCastlingRights);
+                (!attacked(F1) 
+              && !attacked(G1))){ // castling path is empty and not attacked
+                moves.emplace_back(E1, G1, KING_CASTLE);
             }
         }
         // Queenside (Q)
         if(board.castlingRights & 2){
             if(!(all & ((1ULL << D1) | (1ULL << C1) | (1ULL << B1))) &&
-                (!board.isSquareAttacked(D1, !side) 
-              && !board.isSquareAttacked(C1, !side))){ // castling path is empty and not attacked
-                moves.emplace_back(E1, C1, QUEEN_CASTLE, K, NO_PIECE, currEnPassant, currCastlingRights);
+                (!attacked(D1) 
+              && !attacked(C1))){ // castling path is empty and not attacked
+                moves.emplace_back(E1, C1, QUEEN_CASTLE);
             }
         }
     } 
-    else if(!board.isKingInCheck(BLACK)){ // king can't castle in check
+    else{
         // Kingside (k)
         if(board.castlingRights & 4){
             if(!(all & ((1ULL << F8) | (1ULL << G8)))&&
-                (!board.isSquareAttacked(F8, !side) 
-              && !board.isSquareAttacked(G8, !side))){ // castling path is empty and not attacked
-                moves.emplace_back(E8, G8, KING_CASTLE, k, NO_PIECE, currEnPassant, currCastlingRights);
+                (!attacked(F8) 
+              && !attacked(G8))){ // castling path is empty and not attacked
+                moves.emplace_back(E8, G8, KING_CASTLE);
             }
         }
         // Queenside (q)
         if(board.castlingRights & 8){
             if(!(all & ((1ULL << D8) | (1ULL << C8) | (1ULL << B8)))&&
-                (!board.isSquareAttacked(D8, !side) 
-              && !board.isSquareAttacked(C8, !side))){ // castling path is empty and not attacked
-                moves.emplace_back(E8, C8, QUEEN_CASTLE, k, NO_PIECE, currEnPassant, currCastlingRights);
+                (!attacked(D8) 
+              && !attacked(C8))){ // castling path is empty and not attacked
+                moves.emplace_back(E8, C8, QUEEN_CASTLE);
             }
         }
     }
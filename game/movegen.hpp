@@ -1,22 +1,73 @@
 #pragma once
-#include <vector>
 #include "board.hpp"
 
+constexpr int MAX_MOVES = 256; // no legal chess position has more than 218 moves
+
+// Fixed-capacity list of moves that lives on the stack,
+// so generating moves never touches the heap
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int count = 0;
+
+    template <typename... Args>
+    void emplace_back(Args... args){ moves[count++] = Move(args...); }
+    void push_back(const Move& move){ moves[count++] = move; }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move& operator[](int i){ return moves[i]; }
+    const Move& operator[](int i) const { return moves[i]; }
+
+    Move* begin(){ return moves; }
+    Move* end(){ return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+};
+
+// Legality info for one position, computed once per generateMoves call
+struct MoveMasks {
+    uint64_t checkers;  // enemy pieces giving check to our king
+    uint64_t pinned;    // our pieces pinned to our king
+    uint64_t checkMask; // squares a non-king move has to land on (all squares if not in check)
+    int kingSquare;     // our king (NO_SQUARE if there is none)
+};
+
+// Which moves to generate
+enum GenType {
+    ALL_MOVES,
+    CAPTURES, // captures, en passant and queen promotions
+    QUIETS,   // everything else (quiet moves, castling, underpromotions)
+    QUIET_CHECKS, // the QUIETS moves that give check (for quiescence)
+    EVASIONS  // all legal moves when in check (ALL_MOVES in check uses this too)
+};
+
 // generates all possible moves for a given board
 class MoveGenerator {
 public:
-    // Generates all legal moves for the current position
-    static std::vector<Move> generateMoves(const Board& board);
-    static int currEnPassant;
-    static int currCastlingRights;
+    // Generates all legal moves of the given type for the current position
+    static MoveList generateMoves(const Board& board, GenType type = ALL_MOVES);
+
+    // Is `move` a legal move in this position? (for moves from other
+    // positions, like killers or hash moves)
+    static bool isLegal(const Board& board, Move move);
+
+    // Does the (legal) `move` put the opponent in check?
+    static bool givesCheck(const Board& board, Move move);
+
+    // Checkers, pinned pieces and check mask for the side to move
+    static MoveMasks computeMasks(const Board& board);
 private:
     
-    // Generate moves for each piece
-    static void generatePawnMoves(const Board& board, std::vector<Move>& moves);
-    static void generateKnightMoves(const Board& board, std::vector<Move>& moves);
-    static void generateBishopMoves(const Board& board, std::vector<Move>& moves);
-    static void generateRookMoves(const Board& board, std::vector<Move>& moves);
-    static void generateQueenMoves(const Board& board, std::vector<Move>& moves);
-    static void generateKingMoves(const Board& board, std::vector<Move>& moves);
+    // Generate legal moves for each piece
+    static void generatePawnMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type);
+    static void generateKnightMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type);
+    static void generateBishopMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type);
+    static void generateRookMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type);
+    static void generateQueenMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type);
+    static void generateKingMoves(const Board& board, MoveList& moves, const MoveMasks& masks, GenType type);
+
+    // Check evasions: king steps, captures of the checker and blocks
+    static void generateEvasions(const Board& board, MoveList& moves, const MoveMasks& masks);
 
 };
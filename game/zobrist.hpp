@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+// --- Zobrist keys ---
+/*
+Every feature of a position (a piece on a square, the side to move, each
+castling rights combination, the en passant file) gets a random 64-bit
+number. The position key is the XOR of the numbers of all features that
+are present, so a move only has to XOR out what changed and XOR in what
+is new.
+*/
+struct ZobristKeys {
+    uint64_t psq[12][64];    // [piece][square]
+    uint64_t castling[16];   // [castlingRights] (KQkq bits)
+    uint64_t enPassant[8];   // [file of the en passant square]
+    uint64_t side;           // XORed in when black is to move
+};
+
+// splitmix64, fixed seed so keys are the same on every run
+constexpr uint64_t zobristNext(uint64_t& s){
+    uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys buildZobristKeys(){
+    ZobristKeys z{};
+    uint64_t s = 1070372ULL;
+    for(int pc = 0; pc < 12; pc++)
+        for(int sq = 0; sq < 64; sq++)
+            z.psq[pc][sq] = zobristNext(s);
+    for(int i = 0; i < 16; i++)
+        z.castling[i] = zobristNext(s);
+    for(int f = 0; f < 8; f++)
+        z.enPassant[f] = zobristNext(s);
+    z.side = zobristNext(s);
+    return z;
+}
+
+inline constexpr ZobristKeys zobrist = buildZobristKeys();
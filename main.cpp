@@ -2,13 +2,14 @@
 #include <sstream>
 #include <string>
 #include <map>
-#include <vector>
 #include "game/bitboard.hpp"
 #include "game/board.hpp"
 #include "game/movegen.hpp"
 #include "engine/search.hpp"
 #include "engine/eval.hpp"
 #include "engine/nnue.hpp"
+#include "engine/tt.hpp"
+#include "engine/threads.hpp"
 
 static Board board;
 std::string startFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
@@ -35,28 +36,29 @@ void applyMoves(Board& board, const std::string& movesPart) {
         char promo = 0;
         if (moveStr.length() == 5) promo = moveStr[4];
 
-        std::vector<Move> legalMoves = MoveGenerator::generateMoves(board);
+        MoveList legalMoves = MoveGenerator::generateMoves(board);
         for (auto& move : legalMoves) {
             char movePromo = 0;
-            switch(move.flag){
+            switch(move.flag()){
                 case PROMOTION_QUEEN: movePromo = 'q'; break;
                 case PROMOTION_ROOK: movePromo = 'r'; break;
                 case PROMOTION_BISHOP: movePromo = 'b'; break;
                 case PROMOTION_KNIGHT: movePromo = 'n'; break;
+                default: break;
             }
-            if (move.from == from && move.to == to && (promo == 0 || movePromo == promo)) {
+            if (move.from() == from && move.to() == to && (promo == 0 || movePromo == promo)) {
                 board.makeMove(move);
                 break;
             }
         }
     }
 }
-/*
-int main() {
+// UCI protocol loop (default mode)
+void uciLoop() {
     std::ios::sync_with_stdio(false);
     std::cin.tie(nullptr);
 
-    init_eval();
+    TT.resize(engineOptions.hash);
 
     std::string line;
     while (std::getline(std::cin, line)) {
@@ -76,6 +78,8 @@ int main() {
             std::cout << "readyok\n" << std::flush;
         }
         else if (line.rfind("setoption name", 0) == 0) {
+            Threads.wait(); // options only change between searches
+
             // Parse UCI setoption commands
             std::istringstream iss(line);
             std::string token, name, value;
@@ -90,14 +94,20 @@ int main() {
                 engineOptions.moveOverhead = std::stoi(valueStr);
             } else if (name == "Threads") {
                 engineOptions.threads = std::stoi(valueStr);
+                Threads.setThreads(engineOptions.threads);
             } else if (name == "Hash") {
                 engineOptions.hash = std::stoi(valueStr);
+                TT.resize(engineOptions.hash);
             }
         }
         else if (line == "ucinewgame") {
+            Threads.wait();
             board.loadFEN(startFEN);
+            TT.clear();
+            Threads.clear();
         }
         else if (line.rfind("position", 0) == 0) {
+            Threads.wait();
             std::istringstream iss(line);
             std::string token;
             iss >> token; // 'position'
@@ -122,44 +132,46 @@ int main() {
             }
         }
         else if (line.rfind("go", 0) == 0) {
-            int depth = 5;
+            SearchLimits limits;
+            limits.moveOverhead = engineOptions.moveOverhead;
             std::istringstream iss(line);
             std::string tok;
             while (iss >> tok) {
-                if (tok == "depth") iss >> depth;
+                if (tok == "depth") iss >> limits.depth;
+                else if (tok == "wtime") iss >> limits.wtime;
+                else if (tok == "btime") iss >> limits.btime;
+                else if (tok == "winc") iss >> limits.winc;
+                else if (tok == "binc") iss >> limits.binc;
+                else if (tok == "movestogo") iss >> limits.movestogo;
+                else if (tok == "movetime") iss >> limits.movetime;
+                else if (tok == "nodes") iss >> limits.nodes;
             }
 
-            Search search(depth);
-            SearchResult best = search.findBestMove(board);
-            Move bestMove = best.bestMove;
-            board.makeMove(bestMove);
-            std::cout << "bestmove " << bestMove.toString() << "\n" << std::flush;
+            // runs in the background, the main search thread prints bestmove
+            Threads.start(board, limits, true);
+        }
+        else if (line == "stop") {
+            Threads.stop();
+            Threads.wait();
         }
         else if (line == "quit") {
             break;
         }
     }
-
-    return 0;
 }
-*/
 
 
 
 
-int main() {
+void playConsoleGame() {
     // ==================== CHESS GAME ====================
-    init_eval();
+    TT.resize(engineOptions.hash);
 
-    
-    
-    
     Board board;
     // Standard starting FEN
     std::string startFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
     // Load the FEN into the board
-    board.loadFEN(startFEN);
-    board.build_accumulators(board, board.us, board.them);
+    board.loadFEN(startFEN); // also builds the NNUE accumulators
     std::cout << "Welcome to your chess engine!\n";
     board.printBoard();
     std::cout<<evaluate_board(board)<<"\n";
@@ -186,7 +198,7 @@ int main() {
             int from = fromRank * 8 + fromFile;
             int to   = toRank * 8 + toFile;
 
-            std::vector<Move> legalMoves = MoveGenerator::generateMoves(board);
+            MoveList legalMoves = MoveGenerator::generateMoves(board);
             if (legalMoves.empty()) {
                 if (board.isKingInCheck(board.turn))
                     std::cout << "Checkmate! You Lose!\n";
@@ -197,7 +209,7 @@ int main() {
    
             bool found = false;
             for (auto& move : legalMoves) {
-                if (move.from == from && move.to == to) {
+                if (move.from() == from && move.to() == to) {
                     board.makeMove(move);
                     found = true;
                     break;
@@ -211,7 +223,7 @@ int main() {
         } 
         else {
             // Engine move
-            std::vector<Move> legalMoves = MoveGenerator::generateMoves(board);
+            MoveList legalMoves = MoveGenerator::generateMoves(board);
             if (legalMoves.empty()) {
                 if (board.isKingInCheck(board.turn))
                     std::cout << "Checkmate! You win!\n";
@@ -220,8 +232,10 @@ int main() {
                 break;
             }
 
-            Search search(5);
-            SearchResult best = search.findBestMove(board);
+            SearchLimits limits;
+            limits.depth = 5;
+            Threads.start(board, limits, false);
+            SearchResult best = Threads.wait();
             Move bestMove = best.bestMove; // random move for now
             board.makeMove(bestMove);
             std::cout << "Engine plays: " << bestMove.toString() << "\n";
@@ -232,3 +246,17 @@ int main() {
 
     std::cout << "Game over.\n";
 }
+
+int main(int argc, char* argv[]) {
+    init_eval();
+
+    // "play" starts the console game against the engine, anything else speaks UCI
+    if (argc > 1 && std::string(argv[1]) == "play")
+        playConsoleGame();
+    else
+        uciLoop();
+
+    Threads.stop();
+    Threads.wait();
+    return 0;
+}
@@ -7,8 +7,8 @@
 // Reference: https://www.chessprogramming.org/Perft_Results
 
 int val = 0;
-uint64_t perft(Board board, int depth){
-	std::vector<Move> legalMoves = MoveGenerator::generateMoves(board);
+uint64_t perft(Board& board, int depth){
+	MoveList legalMoves = MoveGenerator::generateMoves(board);
 	
 	if(depth==0){
 		return 1;
@@ -16,9 +16,9 @@ uint64_t perft(Board board, int depth){
 	uint64_t ans = 0;
 	for(auto& move : legalMoves){
 		// Board copy = board;
-		board.makeMove(move);
+		board.makeMove<false>(move); // no NNUE updates, pure movegen speed
 		val = perft(board, depth-1);
-		board.unmakeMove(move);
+		board.unmakeMove<false>(move);
 		// board = copy;
 		ans += val;
 		/*
@@ -0,0 +1,57 @@
+#include "../game/board.hpp"
+#include "../engine/order.hpp"
+#include "doctest.h"
+
+// Exchange value of `move` in `fen`, pinned down exactly:
+// see() has to accept `value` and reject `value + 1`
+static void checkSEE(std::string fen, Move move, int value){
+	Board board;
+	board.loadFEN(fen);
+	INFO(fen, " ", move.toString());
+	CHECK(see(board, move, value));
+	CHECK_FALSE(see(board, move, value + 1));
+}
+
+
+TEST_CASE("see") {
+
+	// undefended pawn
+	checkSEE("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", Move(E1, E5, CAPTURE), 100);
+	// knight for a pawn: Bxe5 (or the queen x-ray) takes back
+	checkSEE("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", Move(D3, E5, CAPTURE), -200);
+
+	// x-rays: the rook behind the first one recaptures
+	checkSEE("3r2k1/8/8/8/3p4/8/3R4/3RK3 w - - 0 1", Move(D2, D4, CAPTURE), 100);
+	checkSEE("3r2k1/8/8/8/3p4/8/3R4/4K3 w - - 0 1", Move(D2, D4, CAPTURE), -400);
+	// the defender's battery: Rd8 only joins in once Rd7 has recaptured
+	checkSEE("3r2k1/3r4/8/3p4/8/2N5/3R4/6K1 w - - 0 1", Move(C3, D5, CAPTURE), -200);
+	// queen behind the bishop on the diagonal takes back once fxe5 is played
+	checkSEE("6k1/8/5p2/4p3/3B4/2Q5/8/6K1 w - - 0 1", Move(D4, E5, CAPTURE), -100);
+
+	// recapture chains: queen for queen, then the rook takes the queen back
+	checkSEE("3k4/8/8/8/8/3q4/3Q4/3K4 w - - 0 1", Move(D2, D3, CAPTURE), 900);
+	checkSEE("3k4/3r4/8/8/8/3q4/3Q4/3K4 w - - 0 1", Move(D2, D3, CAPTURE), 0);
+	checkSEE("3k4/3r4/8/8/8/3q4/3R4/3K4 w - - 0 1", Move(D2, D3, CAPTURE), 400);
+
+	// queen takes a pawn defended by a pawn
+	checkSEE("4k3/8/8/3p4/8/8/8/3QK3 w - - 0 1", Move(D1, D5, CAPTURE), 100);
+	checkSEE("4k3/8/4p3/3p4/8/8/8/3QK3 w - - 0 1", Move(D1, D5, CAPTURE), -800);
+
+	// quiet moves: only what the moved piece risks
+	checkSEE("4k3/8/8/3p4/8/8/8/3QK3 w - - 0 1", Move(D1, D4, QUIET), 0);
+	checkSEE("4k3/8/8/8/2p5/8/8/3QK3 w - - 0 1", Move(D1, D3, QUIET), -900);
+
+	// promotion: the pawn turns into a queen that nobody can take
+	checkSEE("4k3/8/8/8/8/8/1p6/K1N5 b - - 0 1", Move(B2, C1, PROMOTION_QUEEN), 1100);
+
+	// the king can't recapture on a square the x-ray rook still covers
+	checkSEE("8/8/4k3/3p4/8/8/3R4/3RK3 w - - 0 1", Move(D2, D5, CAPTURE), 100);
+	// but it can when nothing stands behind the rook
+	checkSEE("8/8/4k3/3p4/8/8/3R4/4K3 w - - 0 1", Move(D2, D5, CAPTURE), -400);
+
+	// en passant wins the pawn
+	checkSEE("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", Move(E5, D6, EN_PASSANT), 100);
+
+	// castling never loses material
+	checkSEE("4k3/8/8/8/8/8/8/4K2R w K - 0 1", Move(E1, G1, KING_CASTLE), 0);
+}
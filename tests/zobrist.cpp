@@ -0,0 +1,64 @@
+#include "../game/board.hpp"
+#include "../game/movegen.hpp"
+#include "doctest.h"
+
+// true if the incremental keys match the ones computed from scratch
+// (computeKeys overwrites them with the same values when they do)
+static bool keysMatch(Board& board){
+	uint64_t key = board.key, pawnKey = board.pawnKey;
+	board.computeKeys();
+	return key == board.key && pawnKey == board.pawnKey;
+}
+
+// Walk the whole tree to `depth`, passing the turn as well wherever that is
+// legal, and count every position whose keys went wrong
+static int badKeys(Board& board, int depth){
+	if(depth == 0) return 0;
+	int bad = 0;
+	uint64_t key = board.key, pawnKey = board.pawnKey;
+
+	for(Move move : MoveGenerator::generateMoves(board)){
+		board.makeMove<false>(move);
+		bad += !keysMatch(board);
+		bad += badKeys(board, depth - 1);
+		board.unmakeMove<false>(move);
+		bad += board.key != key || board.pawnKey != pawnKey; // restored on unmake
+	}
+
+	if(!board.isKingInCheck(board.turn)){
+		board.makeNullMove();
+		bad += !keysMatch(board);
+		bad += badKeys(board, depth - 1);
+		board.unmakeNullMove();
+		bad += board.key != key || board.pawnKey != pawnKey;
+	}
+	return bad;
+}
+
+static int runKeys(std::string fen, int depth){
+	Board board;
+	board.loadFEN(fen);
+	return badKeys(board, depth);
+}
+
+
+TEST_CASE("zobrist") {
+
+	CHECK(runKeys("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 3) == 0);
+	CHECK(runKeys("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -", 3) == 0);
+	CHECK(runKeys("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 3) == 0);
+	CHECK(runKeys("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3) == 0);
+	CHECK(runKeys("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3) == 0);
+	CHECK(runKeys("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 3) == 0);
+
+	// transpositions: the same position reached in a different order has the same key
+	Board a, b;
+	a.loadFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+	b.loadFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+	a.makeMove<false>(Move(G1, F3)); a.makeMove<false>(Move(G8, F6)); a.makeMove<false>(Move(B1, C3));
+	b.makeMove<false>(Move(B1, C3)); b.makeMove<false>(Move(G8, F6)); b.makeMove<false>(Move(G1, F3));
+	CHECK(a.key == b.key);
+	// the side to move is part of the key
+	a.makeNullMove();
+	CHECK(a.key != b.key);
+}